@@ -6,7 +6,6 @@
 #include "aliaswriter.h"
 #include "splitter.h"
 
-#define MAX_PROJ_INPUTS 80
 //#define INPUTS_PER_PORT 80
 //#define MAX_INPUT_PORTS 80
 //#define MAX_POP_SIZE 100
@@ -49,6 +48,10 @@ void DamsonAliasWriter::writePopulation(Population *sub_population, Population *
     //hash tables
     writeHashTableData(sub_population, population);
 
+    //node partition and node local maxima
+    if (unsplit_pop_info->partition.isHierarchical())
+        writeNodeData(sub_population, population);
+
     // open used output ports (neuron only)
     writeActivePortsData(unsplit_neuron_name);
 
@@ -81,9 +84,19 @@ void DamsonAliasWriter::writePopulation(Population *sub_population, Population *
 
 }
 
+//orders hash table entries with sources in the same node partition first
+static bool nodeLocalLessThan(const DAMSONInputHash &h1, const DAMSONInputHash &h2)
+{
+    if (h1.node_local != h2.node_local)
+        return h1.node_local;
+    return h1 < h2;
+}
+
 void DamsonAliasWriter::writeHashTableData(Population* sub_population, Population *population)
 {
     uint sub_pop_index = info->getSubPopulationIndex(sub_population->neuron->name);
+    PopulationPartition partition = info->getUnsplitPopulationInfo(sub_population->neuron->name)->partition;
+    uint node = partition.node(sub_pop_index);
 
     // data for hash tables (INPUT ROWS TO WEIGHTUPDATE not supported)
     QHash <int, DAMSONInputHash> inputs;
@@ -97,8 +110,7 @@ void DamsonAliasWriter::writeHashTableData(Population* sub_population, Populatio
     for (int p=0; p<population->projections.values().size();p++ ){
         Projection *projection = population->projections.values()[p];
         PopulationInfo *proj_target_info = info->getPopulationInfo(projection->proj_population);
-        uint proj_target_size = proj_target_info->size;
-        uint proj_target_sub_count = UINT_DIV_CEIL(proj_target_size, MAX_POPULATION_SIZE);
+        uint proj_target_sub_count = proj_target_info->partition.count();
         for(int s=0; s<projection->synapses.values().size(); s++){
             Synapse* synapse = projection->synapses.values()[s];
             uint sub_syn_rows = 0;  //this is our ordered index for unique sub population sources
@@ -120,6 +132,7 @@ void DamsonAliasWriter::writeHashTableData(Population* sub_population, Populatio
                     h.src_node_number = proj_src_alias;
                     h.src_switch_value = proj_target_info->global_index;
                     h.src_split_index = sub_syn_rows++;
+                    h.node_local = (proj_target_info->partition.node(proj_src_sub_index) == node);
                     //add the hash table entry
                     if (!inputs.contains(h.src_node_number)){
                         inputs[h.src_node_number] = h;
@@ -140,8 +153,7 @@ void DamsonAliasWriter::writeHashTableData(Population* sub_population, Populatio
     for (int i=0; i<population->neuron->inputs.values().size();i++ ){
             Input *unsplit_input = population->neuron->inputs.values()[i];
             PopulationInfo *input_src_info = info->getPopulationInfo(unsplit_input->src);
-            uint input_src_size = input_src_info->size;
-            uint input_src_sub_count = UINT_DIV_CEIL(input_src_size, MAX_POPULATION_SIZE);
+            uint input_src_sub_count = input_src_info->partition.count();
             uint sub_inp_rows = 0;   //this is our ordered index for unique sub population sources
             for(uint d=0;d<input_src_sub_count; d++){
                 QString sub_inp_name = "%1_%2_%3_sub%4";
@@ -155,6 +167,7 @@ void DamsonAliasWriter::writeHashTableData(Population* sub_population, Populatio
                     h.src_node_number = input_src_alias;
                     h.src_switch_value = input_src_info->global_index;
                     h.src_split_index = sub_inp_rows++;
+                    h.node_local = (input_src_info->partition.node(input_src_sub_index) == node);
                     if (!inputs.contains(h.src_node_number)){
                         inputs[h.src_node_number] = h;
                     }else{
@@ -172,11 +185,9 @@ void DamsonAliasWriter::writeHashTableData(Population* sub_population, Populatio
     //input rows to post synapse
     for (int p=0; p<population->projections.values().size();p++ ){
         Projection *projection = population->projections.values()[p];
-        ComponentInfo *proj_target_info = info->getComponentInfo(projection->proj_population);
 
         //target is the named src or dst of the projection
-        uint proj_target_size = proj_target_info->size;
-        uint proj_target_sub_count = UINT_DIV_CEIL(proj_target_size, MAX_POPULATION_SIZE);
+        uint proj_target_sub_count = info->getPartition(projection->proj_population).count();
         for(int s=0; s<projection->synapses.values().size(); s++){
             Synapse* synapse = projection->synapses.values()[s];
 
@@ -184,8 +195,7 @@ void DamsonAliasWriter::writeHashTableData(Population* sub_population, Populatio
                 Input *unsplit_input = synapse->postsynapse->inputs.values()[i];
                 if (!((unsplit_input->src == population->neuron->name)&&(unsplit_input->remapping->Type() == ONE_TO_ONE_CONNECTVITY_TYPE))){ //ignore one to one inputs from self (handled internally)
                     PopulationInfo *input_src_info = info->getPopulationInfo(unsplit_input->src);
-                    uint input_src_size = input_src_info->size;
-                    uint input_src_sub_count = UINT_DIV_CEIL(input_src_size, MAX_POPULATION_SIZE);
+                    uint input_src_sub_count = input_src_info->partition.count();
                     uint sub_inp_rows = 0;
                     //find first sub projection to the sub population (only need the first as psps and any inputs are duplicated for any sub projection to this sub population)
                     for(uint d=0;d<proj_target_sub_count; d++){
@@ -210,6 +220,7 @@ void DamsonAliasWriter::writeHashTableData(Population* sub_population, Populatio
                                     h.src_node_number = input_src_alias;
                                     h.src_switch_value = input_src_info->global_index;
                                     h.src_split_index = sub_inp_rows++;
+                                    h.node_local = (input_src_info->partition.node(input_src_sub_index) == node);
                                     if (!inputs.contains(h.src_node_number)){
                                         inputs[h.src_node_number] = h;
                                     }else{
@@ -236,9 +247,17 @@ void DamsonAliasWriter::writeHashTableData(Population* sub_population, Populatio
         std::cerr << "Error: DAMSON alias writer hash_creation rows exceed for '" << sub_population->neuron->name.toLocal8Bit().data() << "'" << std::endl;
         exit(0);
     }
-    //write inputs in order (for easier human readability)
+    //write inputs in order (for easier human readability), sources in the same node partition first if hierarchical
     ordered_inputs = inputs.values();
-    qSort(ordered_inputs.begin(), ordered_inputs.end());
+    uint node_rows = 0;
+    if (partition.isHierarchical()){
+        qSort(ordered_inputs.begin(), ordered_inputs.end(), nodeLocalLessThan);
+        for (int i=0; i<ordered_inputs.size(); i++){
+            if (ordered_inputs.at(i).node_local)
+                node_rows++;
+        }
+    }else
+        qSort(ordered_inputs.begin(), ordered_inputs.end());
     for (int i=0; i<ordered_inputs.size(); i++){
         QString end_comma;  //if not last entry
         if (i != MAX_PROJ_INPUTS)
@@ -255,10 +274,49 @@ void DamsonAliasWriter::writeHashTableData(Population* sub_population, Populatio
         out << "\t{0,0,0}" << end_comma << endl;
     }
     out << "};" << endl << endl;
+    if (partition.isHierarchical())
+        out << "num_node_hash_rows = " << node_rows << ";" << endl << endl;
     inputs.clear();
     ordered_inputs.clear();
 }
 
+void DamsonAliasWriter::writeNodeData(Population *sub_population, Population *population)
+{
+    PopulationInfo *unsplit_pop_info = info->getUnsplitPopulationInfo(sub_population->neuron->name);
+    uint sub_pop_index = info->getSubPopulationIndex(sub_population->neuron->name);
+    out << "node_index = " << unsplit_pop_info->partition.node(sub_pop_index) << ";" << endl;
+    out << "core_index = " << unsplit_pop_info->partition.core(sub_pop_index) << ";" << endl << endl;
+
+    //maximum sub synapses (and sub inputs) of any sub population within and outside of its node partition
+    for (int p=0; p<population->projections.values().size();p++ ){
+        Projection *projection = population->projections.values()[p];
+        for(int s=0; s<projection->synapses.values().size(); s++){
+            Synapse* synapse = projection->synapses.values()[s];
+            QString node_max_name = sanitizeName(QString("nodeSubSynMax%1").arg(synapse->weightupdate->name));
+            QString remote_max_name = sanitizeName(QString("remoteSubSynMax%1").arg(synapse->weightupdate->name));
+            //every sub synapse is within or outside of its node partition so the levels cannot both be empty
+            if ((synapse->_sub_syn_max > 0) && (synapse->_sub_syn_node_max + synapse->_sub_syn_remote_max == 0)){
+                std::cerr << "Error: Node maxima missing for sub synapses of '" << synapse->weightupdate->name.toLocal8Bit().data() << "'." << std::endl;
+                exit(0);
+            }
+            out << node_max_name << " = " << synapse->_sub_syn_node_max << ";" << endl;
+            out << remote_max_name << " = " << synapse->_sub_syn_remote_max << ";" << endl;
+        }
+    }
+    for (int i=0; i<population->neuron->inputs.values().size();i++ ){
+        Input *unsplit_input = population->neuron->inputs.values()[i];
+        QString node_max_name = sanitizeName(QString("nodeSubInpMax%1_input_%2").arg(population->neuron->name).arg(unsplit_input->unsplit_index+1));
+        QString remote_max_name = sanitizeName(QString("remoteSubInpMax%1_input_%2").arg(population->neuron->name).arg(unsplit_input->unsplit_index+1));
+        if ((unsplit_input->sub_inp_max > 0) && (unsplit_input->sub_inp_node_max + unsplit_input->sub_inp_remote_max == 0)){
+            std::cerr << "Error: Node maxima missing for sub inputs of '" << population->neuron->name.toLocal8Bit().data() << "' from '" << unsplit_input->src.toLocal8Bit().data() << "'." << std::endl;
+            exit(0);
+        }
+        out << node_max_name << " = " << unsplit_input->sub_inp_node_max << ";" << endl;
+        out << remote_max_name << " = " << unsplit_input->sub_inp_remote_max << ";" << endl;
+    }
+    out << endl;
+}
+
 void DamsonAliasWriter::writeActivePortsData(QString unsplit_neuron_name)
 {
     QSet<QString> active_ports = QSet<QString>::fromList(info->getActiveSourcePorts(unsplit_neuron_name));
@@ -271,6 +329,8 @@ void DamsonAliasWriter::writeActivePortsData(QString unsplit_neuron_name)
 
 void DamsonAliasWriter::writeAllExplicitNeuronPropertyData(Population *sub_population, QString unsplit_neuron_name)
 {
+    uint partition_size = info->getPartitionSize(unsplit_neuron_name);
+
     for(int p=0; p< sub_population->neuron->properties.size(); p++){
         Property* sub_prop = sub_population->neuron->properties.at(p);
         if (sub_prop->value->Type() == VALUE_LIST_TYPE){
@@ -279,17 +339,16 @@ void DamsonAliasWriter::writeAllExplicitNeuronPropertyData(Population *sub_popul
             alias_prop_name = alias_prop_name.arg(sub_prop->name, unsplit_neuron_name);
             alias_prop_name = sanitizeName(alias_prop_name);
             out << alias_prop_name << " = {" << endl << "\t";
-            for (uint v=0; v<MAX_POPULATION_SIZE; v++){
-                if (value_list->valueInstances.contains(v)){
-                    PropertyValueInstance* val = value_list->valueInstances[v];
-                    out << val->value;
+            for (uint v=0; v<partition_size; v++){
+                if (value_list->contains(v)){
+                    out << value_list->value(v);
                 }else if (sub_population->neuron->size <= v){
                     out << "0";
                 }else{
                     std::cerr << "Alias Writer Error: Incomplete explicit list property data for neuron '" << unsplit_neuron_name.toLocal8Bit().data() << "' property '" <<  sub_prop->name.toLocal8Bit().data() << "'" << std::endl;
                     exit(0);
                 }
-                if (v == (MAX_POPULATION_SIZE-1))
+                if (v == (partition_size-1))
                     out << endl;
                 else
                     out << ", ";
@@ -302,6 +361,7 @@ void DamsonAliasWriter::writeAllExplicitNeuronPropertyData(Population *sub_popul
 void DamsonAliasWriter::writeAllExplicitPSPropertyData(Population *sub_population, QString unsplit_neuron_name)
 {
     QSet <QString>unique_strings;
+    uint partition_size = info->getPartitionSize(unsplit_neuron_name);
 
     for (int p=0; p<sub_population->projections.values().size();p++ ){
         Projection *sub_proj = sub_population->projections.values()[p];
@@ -317,17 +377,16 @@ void DamsonAliasWriter::writeAllExplicitPSPropertyData(Population *sub_populatio
                     if (!unique_strings.contains(alias_ps_prop_name)){
                         PropertyValueList* value_list = (PropertyValueList*)ps_prop->value;
                         out << alias_ps_prop_name << " = {" << endl << "\t";
-                        for (uint v=0; v<MAX_POPULATION_SIZE; v++){
-                            if (value_list->valueInstances.contains(v)){
-                                PropertyValueInstance* val = value_list->valueInstances[v];
-                                out << val->value;
+                        for (uint v=0; v<partition_size; v++){
+                            if (value_list->contains(v)){
+                                out << value_list->value(v);
                             }else if (sub_population->neuron->size <= v){
                                 out << "0";
                             }else{
                                 std::cerr << "Alias Writer Error: Incomplete explicit list property data for postsynpase '" << unsplit_neuron_name.toLocal8Bit().data() << "' property '" <<  ps_prop->name.toLocal8Bit().data() << "'" << std::endl;
                                 exit(0);
                             }
-                            if (v == (MAX_POPULATION_SIZE-1))
+                            if (v == (partition_size-1))
                                 out << endl;
                             else
                                 out << ", ";
@@ -345,14 +404,15 @@ void DamsonAliasWriter::writeAllExplicitPSPropertyData(Population *sub_populatio
 void DamsonAliasWriter::writeAllExplicitWUPropertyData(Population *sub_population, Population *population)
 {
     uint sub_pop_index = info->getSubPopulationIndex(sub_population->neuron->name);
+    uint partition_size = info->getPartitionSize(population->neuron->name);
 
     for (int p=0; p<population->projections.values().size();p++ ){
         Projection *projection = population->projections.values()[p];
-        ComponentInfo *target_info = info->getComponentInfo(projection->proj_population);
 
         //target is the named src or dst of the projection
-        uint proj_target_size = target_info->size;
-        uint proj_target_sub_count = UINT_DIV_CEIL(proj_target_size, MAX_POPULATION_SIZE);
+        PopulationPartition proj_target_partition = info->getPartition(projection->proj_population);
+        uint proj_target_partition_size = proj_target_partition.max_size;
+        uint proj_target_sub_count = proj_target_partition.count();
         for(int s=0; s<projection->synapses.values().size(); s++){
             Synapse* synapse = projection->synapses.values()[s];
             //get property name
@@ -384,12 +444,11 @@ void DamsonAliasWriter::writeAllExplicitWUPropertyData(Population *sub_populatio
                             Property* wu_prop = sub_synapse->weightupdate->properties.at(i);
                             PropertyValueList* value_list = (PropertyValueList*)wu_prop->value; //assume its the same type (this is a pretty safe assumption!)
                             out << openSubArray(1);
-                            for (uint v=0; v<MAX_POPULATION_SIZE; v++){
-                                if (value_list->valueInstances.contains(v)){
-                                    PropertyValueInstance* val = value_list->valueInstances[v];
-                                    out << arrayValue(val->value, v, MAX_POPULATION_SIZE);
+                            for (uint v=0; v<partition_size; v++){
+                                if (value_list->contains(v)){
+                                    out << arrayValue(value_list->value(v), v, partition_size);
                                 }else if (sub_population->neuron->size <= v){
-                                    out << arrayValue("0", v, MAX_POPULATION_SIZE);
+                                    out << arrayValue("0", v, partition_size);
                                 }else{
                                     std::cerr << "Alias Writer Error: Incomplete explicit list property data for one to one weightupdate '" << sub_syn_name.toLocal8Bit().data() << "' property '" <<  wu_prop->name.toLocal8Bit().data() << "'" << std::endl;
                                     exit(0);
@@ -403,12 +462,7 @@ void DamsonAliasWriter::writeAllExplicitWUPropertyData(Population *sub_populatio
                             for(uint d=0;d<proj_target_sub_count; d++){
                                 QString sub_proj_name = "%1_sub%2";
                                 sub_proj_name = sub_proj_name.arg(projection->proj_population).arg(d);
-                                uint proj_target_sub_size = MAX_POPULATION_SIZE;
-                                if (d == (proj_target_sub_count-1)){
-                                    uint r = proj_target_size % MAX_POPULATION_SIZE;
-                                    if (r != 0)
-                                        proj_target_sub_size = r;
-                                }
+                                uint proj_target_sub_size = proj_target_partition.size(d);
                                 //get the sub projection
                                 Projection* sub_projection = sub_population->projections[sub_proj_name];
                                 if (!sub_projection){
@@ -425,23 +479,22 @@ void DamsonAliasWriter::writeAllExplicitWUPropertyData(Population *sub_populatio
                                 Property* wu_prop = sub_synapse->weightupdate->properties.at(i);
                                 PropertyValueList* value_list = (PropertyValueList*)wu_prop->value; //assume its the same type (this is a pretty safe assumption!)
                                 out << openSubArray(1) << endl;
-                                for (uint x=0; x<MAX_POPULATION_SIZE; x++){ //dst neurons
+                                for (uint x=0; x<proj_target_partition_size; x++){ //dst neurons
                                     out << openSubArray(2);
-                                    for (uint y=0; y<MAX_POPULATION_SIZE; y++){ //src neurons
+                                    for (uint y=0; y<partition_size; y++){ //src neurons
                                         uint index = (x*sub_population->neuron->size) + y;
                                         if (sub_population->neuron->size<= y){
                                             out << "0";
-                                        }else if (value_list->valueInstances.contains(index)){
-                                            PropertyValueInstance* val = value_list->valueInstances[index];
-                                            out << arrayValue(val->value, y, MAX_POPULATION_SIZE);
+                                        }else if (value_list->contains(index)){
+                                            out << arrayValue(value_list->value(index), y, partition_size);
                                         }else if (proj_target_sub_size <= x){
-                                            out << arrayValue("0", y, MAX_POPULATION_SIZE);
+                                            out << arrayValue("0", y, partition_size);
                                         }else{
                                             std::cerr << "Alias Writer Error: Incomplete explicit list property data for all to all weightupdate '" << sub_syn_name.toLocal8Bit().data() << "' property '" <<  wu_prop->name.toLocal8Bit().data() << "'" << std::endl;
                                             exit(0);
                                         }
                                     }
-                                    out << closeSubArray(0, x, MAX_POPULATION_SIZE) << endl;
+                                    out << closeSubArray(0, x, proj_target_partition_size) << endl;
                                 }
                                 out << closeSubArray(1, d, proj_target_sub_count) << endl;
                             }
@@ -469,24 +522,28 @@ void DamsonAliasWriter::writeAllExplicitWUPropertyData(Population *sub_populatio
                                     //itterate all possible connections and delay value
                                     ConnectionList* connection_list = (ConnectionList*)sub_synapse->connection;
                                     out << openSubArray(1) << endl;
-                                    for (uint y=0; y<MAX_POPULATION_SIZE; y++){
+                                    connection_list->buildTransposed();
+                                    for (uint y=0; y<proj_target_partition_size; y++){
                                         out << openSubArray(2);
-                                        for (uint x=0; x<MAX_POPULATION_SIZE; x++){
-                                            ConnectionInstance* conn = connection_list->connectionMatrix[x][y];
-                                            if (conn){
-                                                PropertyValueInstance * val = value_list->valueInstances[conn->index];  //use connection idex to get the correct property
-                                                if (val)
-                                                    out << arrayValue(val->value, x, MAX_POPULATION_SIZE);
+                                        uint t = connection_list->colStart(y);              //column entries are ordered by row
+                                        for (uint x=0; x<partition_size; x++){
+                                            int c = -1;
+                                            if ((t < connection_list->colEnd(y)) && (connection_list->t_rows[t] == x))
+                                                c = connection_list->t_positions[t++];
+                                            if (c >= 0){
+                                                uint index = connection_list->indices[c];  //use connection idex to get the correct property
+                                                if (value_list->contains(index))
+                                                    out << arrayValue(value_list->value(index), x, partition_size);
                                                 else{
-                                                    qDebug() << "Internal error: missing weightupdate property value for connection at index '" << conn->index << "' in sub synapse '" << sub_syn_name << "'.";
+                                                    qDebug() << "Internal error: missing weightupdate property value for connection at index '" << connection_list->indices[c] << "' in sub synapse '" << sub_syn_name << "'.";
                                                     exit(0);
                                                 }
                                             }else{
                                                 //no property value
-                                                out << arrayValue("0", x, MAX_POPULATION_SIZE);
+                                                out << arrayValue("0", x, partition_size);
                                             }
                                         }
-                                        out << closeSubArray(0, y, MAX_POPULATION_SIZE) << endl;
+                                        out << closeSubArray(0, y, proj_target_partition_size) << endl;
                                     }
                                     out << closeSubArray(1, d, proj_target_sub_count) << endl;
                                     sub_syn_rows++;
@@ -496,7 +553,7 @@ void DamsonAliasWriter::writeAllExplicitWUPropertyData(Population *sub_populatio
                             //pad sub_syn_rows
                             for (uint x=sub_syn_rows; x< synapse->_sub_syn_max; x++){
                                 out << openSubArray(1) << endl;
-                                outputEmptyMatrix(MAX_POPULATION_SIZE, 2);
+                                outputEmptyMatrix(proj_target_partition_size, partition_size, 2);
                                 out << closeSubArray(1, x, synapse->_sub_syn_max) << endl;
 
                             }
@@ -521,11 +578,9 @@ void DamsonAliasWriter::writeAllExplicitSynapseData(Population *sub_population,
 
     for (int p=0; p<population->projections.values().size();p++ ){
         Projection *projection = population->projections.values()[p];
-        ComponentInfo *target_info = info->getComponentInfo(projection->proj_population);
 
         //target is the named src or dst of the projection
-        uint proj_target_size = target_info->size;
-        uint proj_target_sub_count = UINT_DIV_CEIL(proj_target_size, MAX_POPULATION_SIZE);
+        uint proj_target_sub_count = info->getPartition(projection->proj_population).count();
         for(int s=0; s<projection->synapses.values().size(); s++){
             Synapse* synapse = projection->synapses.values()[s];
             //write connection and delay data
@@ -538,6 +593,9 @@ void DamsonAliasWriter::writeAllExplicitSynapseData(Population *sub_population,
 
 void DamsonAliasWriter::writeSingleExplicitSynapseData(ConnectionWriteMode mode, Projection* projection, uint proj_target_sub_count, Synapse *synapse, Population* sub_population, uint sub_pop_index)
 {
+    uint partition_size = info->getUnsplitPopulationInfo(sub_population->neuron->name)->partition.max_size;
+    uint proj_target_partition_size = info->getPartitionSize(projection->proj_population);
+
     //only if no delay type is specified
     if (synapse->connection->Type() == LIST_CONNECTVITY_TYPE){                     //only for explicit list connectivity type
         QString alias_connectivity_name;
@@ -573,27 +631,31 @@ void DamsonAliasWriter::writeSingleExplicitSynapseData(ConnectionWriteMode mode,
                 //itterate all possible connections and delay value
                 ConnectionList* connection_list = (ConnectionList*)sub_synapse->connection;
                 out << openSubArray(1) << endl;
-                for (uint y=0; y<MAX_POPULATION_SIZE; y++){
+                connection_list->buildTransposed();
+                for (uint y=0; y<proj_target_partition_size; y++){
                     out << openSubArray(2);
-                    for (uint x=0; x<MAX_POPULATION_SIZE; x++){
-                        ConnectionInstance* conn = connection_list->connectionMatrix[x][y];
-                        if (conn){
+                    uint t = connection_list->colStart(y);              //column entries are ordered by row
+                    for (uint x=0; x<partition_size; x++){
+                        int c = -1;
+                        if ((t < connection_list->colEnd(y)) && (connection_list->t_rows[t] == x))
+                            c = connection_list->t_positions[t++];
+                        if (c >= 0){
                             //output 1 (connection) or delay value
                             switch (mode){
                                 case (ALIAS_MODE_CONNECTION_DATA):{
-                                    out << arrayValue("1", x, MAX_POPULATION_SIZE);
+                                    out << arrayValue("1", x, partition_size);
                                     break;
                                 }
                                 case(ALIAS_MODE_DELAY_DATA):{
-                                    out << arrayValue((float)conn->delay, x, MAX_POPULATION_SIZE);
+                                    out << arrayValue((float)connection_list->delays[c], x, partition_size);
                                     break;
                                 }
                             }
                         }else{
-                            out << arrayValue("0", x, MAX_POPULATION_SIZE);
+                            out << arrayValue("0", x, partition_size);
                         }
                     }
-                    out << closeSubArray(0, y, MAX_POPULATION_SIZE) << endl;
+                    out << closeSubArray(0, y, proj_target_partition_size) << endl;
 
                 }
                 out << closeSubArray(1, d, proj_target_sub_count) << endl;
@@ -603,7 +665,7 @@ void DamsonAliasWriter::writeSingleExplicitSynapseData(ConnectionWriteMode mode,
         //pad sub_syn_rows
         for (uint x=sub_syn_rows; x< synapse->_sub_syn_max; x++){
             out << openSubArray(1) << endl;
-            outputEmptyMatrix(MAX_POPULATION_SIZE, 2);
+            outputEmptyMatrix(proj_target_partition_size, partition_size, 2);
             out << closeSubArray(1, x, synapse->_sub_syn_max) << endl;
 
         }
@@ -627,9 +689,10 @@ void DamsonAliasWriter::writeAllExplicitNeuronInputData(Population *sub_populati
 void DamsonAliasWriter::writeSingleExplicitNeuronInputData(ConnectionWriteMode mode, QString unsplit_component_name, Input *unsplit_input, QHash<QString, Input *> &split_inputs)
 {
     //target is the named src of the input
-    ComponentInfo *target_info = info->getComponentInfo(unsplit_input->src);
-    uint input_src_size = target_info->size;
-    uint input_src_sub_count = UINT_DIV_CEIL(input_src_size, MAX_POPULATION_SIZE);
+    PopulationPartition input_src_partition = info->getPartition(unsplit_input->src);
+    uint input_src_partition_size = input_src_partition.max_size;
+    uint input_src_sub_count = input_src_partition.count();
+    uint partition_size = info->getPartitionSize(unsplit_component_name);
 
     if (unsplit_input->remapping->Type() == LIST_CONNECTVITY_TYPE){                     //only for explicit list connectivity type
         QString alias_connectivity_name;
@@ -659,27 +722,31 @@ void DamsonAliasWriter::writeSingleExplicitNeuronInputData(ConnectionWriteMode m
                 //itterate all possible connections and delay value
                 ConnectionList* connection_list = (ConnectionList*)sub_input->remapping;
                 out << openSubArray(1) << endl;
-                for (uint y=0; y<MAX_POPULATION_SIZE; y++){
+                connection_list->buildTransposed();
+                for (uint y=0; y<input_src_partition_size; y++){
                     out << openSubArray(2);
-                    for (uint x=0; x<MAX_POPULATION_SIZE; x++){
-                        ConnectionInstance* conn = connection_list->connectionMatrix[x][y];
-                        if (conn){
+                    uint t = connection_list->colStart(y);              //column entries are ordered by row
+                    for (uint x=0; x<partition_size; x++){
+                        int c = -1;
+                        if ((t < connection_list->colEnd(y)) && (connection_list->t_rows[t] == x))
+                            c = connection_list->t_positions[t++];
+                        if (c >= 0){
                             //output 1 (connection) or delay value
                             switch (mode){
                                 case (ALIAS_MODE_CONNECTION_DATA):{
-                                    out << arrayValue("1", x, MAX_POPULATION_SIZE);
+                                    out << arrayValue("1", x, partition_size);
                                     break;
                                 }
                                 case(ALIAS_MODE_DELAY_DATA):{
-                                    out << arrayValue((float)conn->delay, x, MAX_POPULATION_SIZE);
+                                    out << arrayValue((float)connection_list->delays[c], x, partition_size);
                                     break;
                                 }
                             }
                         }else{
-                            out << arrayValue("0", x, MAX_POPULATION_SIZE);
+                            out << arrayValue("0", x, partition_size);
                         }
                     }
-                    out << closeSubArray(0, y, MAX_POPULATION_SIZE) << endl;
+                    out << closeSubArray(0, y, input_src_partition_size) << endl;
 
                 }
                 out << closeSubArray(1, d, input_src_sub_count) << endl;
@@ -690,7 +757,7 @@ void DamsonAliasWriter::writeSingleExplicitNeuronInputData(ConnectionWriteMode m
         //pad sub_syn_rows
         for (uint x=sub_inp_rows; x< unsplit_input->sub_inp_max; x++){
             out << openSubArray(1) << endl;
-            outputEmptyMatrix(MAX_POPULATION_SIZE, 2);
+            outputEmptyMatrix(input_src_partition_size, partition_size, 2);
             out << closeSubArray(1, x, unsplit_input->sub_inp_max) << endl;
 
         }
@@ -705,11 +772,9 @@ void DamsonAliasWriter::writeAllExplicitPSInputData(Population *sub_population,
 
     for (int p=0; p<population->projections.values().size();p++ ){
         Projection *projection = population->projections.values()[p];
-        ComponentInfo *target_info = info->getComponentInfo(projection->proj_population);
 
         //target is the named src or dst of the projection
-        uint proj_target_size = target_info->size;
-        uint proj_target_sub_count = UINT_DIV_CEIL(proj_target_size, MAX_POPULATION_SIZE);
+        uint proj_target_sub_count = info->getPartition(projection->proj_population).count();
         for(int s=0; s<projection->synapses.values().size(); s++){
             Synapse* synapse = projection->synapses.values()[s];
             for (int i=0; i<synapse->postsynapse->inputs.values().size();i++ ){
@@ -727,9 +792,10 @@ void DamsonAliasWriter::writeAllExplicitPSInputData(Population *sub_population,
 
 void DamsonAliasWriter::writeSingleExplicitPSInputData(ConnectionWriteMode mode, QString unsplit_component_name, Input *unsplit_input, Projection *projection, uint proj_target_sub_count, Synapse *synapse, Population *sub_population, uint sub_pop_index)
 {
-    ComponentInfo *target_info = info->getComponentInfo(unsplit_input->src);
-    uint input_src_size = target_info->size;
-    uint input_src_sub_count = UINT_DIV_CEIL(input_src_size, MAX_POPULATION_SIZE);
+    PopulationPartition input_src_partition = info->getPartition(unsplit_input->src);
+    uint input_src_partition_size = input_src_partition.max_size;
+    uint input_src_sub_count = input_src_partition.count();
+    uint partition_size = info->getPartitionSize(unsplit_component_name);
 
     //only if no delay type is specified
     if (unsplit_input->remapping->Type() == LIST_CONNECTVITY_TYPE){                     //only for explicit list connectivity type
@@ -774,27 +840,31 @@ void DamsonAliasWriter::writeSingleExplicitPSInputData(ConnectionWriteMode mode,
                         //itterate all possible connections and delay value
                         ConnectionList* connection_list = (ConnectionList*)sub_input->remapping;
                         out << openSubArray(1) << endl;
-                        for (uint y=0; y<MAX_POPULATION_SIZE; y++){
+                        connection_list->buildTransposed();
+                        for (uint y=0; y<input_src_partition_size; y++){
                             out << openSubArray(2);
-                            for (uint x=0; x<MAX_POPULATION_SIZE; x++){
-                                ConnectionInstance* conn = connection_list->connectionMatrix[x][y];
-                                if (conn){
+                            uint t = connection_list->colStart(y);              //column entries are ordered by row
+                            for (uint x=0; x<partition_size; x++){
+                                int c = -1;
+                                if ((t < connection_list->colEnd(y)) && (connection_list->t_rows[t] == x))
+                                    c = connection_list->t_positions[t++];
+                                if (c >= 0){
                                     //output 1 (connection) or delay value
                                     switch (mode){
                                         case (ALIAS_MODE_CONNECTION_DATA):{
-                                            out << arrayValue("1", x, MAX_POPULATION_SIZE);
+                                            out << arrayValue("1", x, partition_size);
                                             break;
                                         }
                                         case(ALIAS_MODE_DELAY_DATA):{
-                                            out << arrayValue((float)conn->delay, x, MAX_POPULATION_SIZE);
+                                            out << arrayValue((float)connection_list->delays[c], x, partition_size);
                                             break;
                                         }
                                     }
                                 }else{
-                                    out << arrayValue("0", x, MAX_POPULATION_SIZE);
+                                    out << arrayValue("0", x, partition_size);
                                 }
                             }
-                            out << closeSubArray(0, y, MAX_POPULATION_SIZE) << endl;
+                            out << closeSubArray(0, y, input_src_partition_size) << endl;
 
                         }
                         out << closeSubArray(1, d, input_src_sub_count) << endl;
@@ -809,7 +879,7 @@ void DamsonAliasWriter::writeSingleExplicitPSInputData(ConnectionWriteMode mode,
         //pad sub_syn_rows
         for (uint x=sub_inp_rows; x< unsplit_input->sub_inp_max; x++){
             out << openSubArray(1) << endl;
-            outputEmptyMatrix(MAX_POPULATION_SIZE, 2);
+            outputEmptyMatrix(input_src_partition_size, partition_size, 2);
             out << closeSubArray(1, x, unsplit_input->sub_inp_max) << endl;
 
         }
@@ -880,7 +950,7 @@ void DamsonAliasWriter::writeLogOutputData(Population *sub_population, Populatio
             }
             out << "#snapshot \"" << sanitizeName(output->name) << "\" 0 1000000 0.000001 \"%f %d\\n\" t current_neuron_index" << endl;
         }else{ //analogue port
-            uint start_index = sub_population->sub_pop_index*MAX_POPULATION_SIZE;
+            uint start_index = info->getPartition(population->neuron->name).start(sub_population->sub_pop_index);
             uint end_index = start_index + sub_population->neuron->size;
 
             //build list of indices
@@ -939,14 +1009,14 @@ void DamsonAliasWriter::errorCheckSynapse(Synapse *synapse, Synapse *sub_synapse
 
 }
 
-void DamsonAliasWriter::outputEmptyMatrix(uint dim, uint tab_depth)
+void DamsonAliasWriter::outputEmptyMatrix(uint rows, uint cols, uint tab_depth)
 {
-    for (uint y=0; y<dim; y++){
+    for (uint y=0; y<rows; y++){
         out << openSubArray(tab_depth);
-        for (uint x=0; x<dim; x++){
-            out << arrayValue(0.0, x, dim);
+        for (uint x=0; x<cols; x++){
+            out << arrayValue(0.0, x, cols);
         }
-        out << closeSubArray(0, y, dim) << endl;
+        out << closeSubArray(0, y, rows) << endl;
     }
 }
 
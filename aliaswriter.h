@@ -5,6 +5,8 @@
 #include "writer.h"
 #include "infoparser.h"
 
+#define MAX_PROJ_INPUTS 80     //rows of the DAMSON input hash table of a sub population
+
 typedef enum{
     ALIAS_MODE_CONNECTION_DATA,
     ALIAS_MODE_DELAY_DATA
@@ -22,6 +24,7 @@ public:
 
 private:
     void writeHashTableData(Population *sub_population, Population *population);
+    void writeNodeData(Population *sub_population, Population *population);     //node and per level maxima of hierarchical splits
     void writeActivePortsData(QString unsplit_neuron_name);
 
     void writeAllExplicitNeuronPropertyData(Population* sub_population, QString unsplit_neuron_name);
@@ -41,7 +44,7 @@ private:
     void writeLogOutputData(Population* sub_population, Population* population, Experiment* experiment);
 
     void errorCheckSynapse(Synapse *synapse, Synapse *sub_synapse, QString sub_syn_name);
-    void outputEmptyMatrix(uint dim, uint tab_depth);
+    void outputEmptyMatrix(uint rows, uint cols, uint tab_depth);
     QString openSubArray(uint depth);
     QString closeSubArray(uint depth, uint i, uint c);
     QString sanitizeName(QString name, QString replacement = "_");
@@ -60,6 +63,7 @@ public:
     uint src_node_number;
     uint src_switch_value;
     uint src_split_index;
+    bool node_local;            //source is in the same node partition (hierarchical splits only)
 public:
     bool operator< (const DAMSONInputHash &h2) const;
     bool operator== (const DAMSONInputHash &h2) const;
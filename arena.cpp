@@ -0,0 +1,164 @@
+#include "arena.h"
+
+#include <cstdlib>
+#include <new>
+
+//allocation header (keeps 8 byte alignment)
+#define ARENA_HEADER_SIZE 8
+#define ARENA_TAG_HEAP  0x48454150
+#define ARENA_TAG_ARENA 0x4152454e
+
+//round up to 8 byte alignment
+#define ARENA_ALIGN(x) (((x) + 7) & ~((size_t)7))
+
+class ArenaLane
+{
+public:
+    ArenaLane(){ pos = NULL; remaining = 0; next_block_size = ARENA_FIRST_BLOCK_SIZE;}
+public:
+    char *pos;
+    size_t remaining;
+    size_t next_block_size;
+    QList<char*> blocks;
+};
+
+static thread_local Arena *current_arena = NULL;
+static thread_local int cached_arena_id = -1;
+static thread_local ArenaLane *cached_lane = NULL;
+static thread_local int thread_index = -1;
+
+QAtomicInt Arena::next_id(0);
+QAtomicInt Arena::next_thread_index(0);
+
+
+Arena::Arena()
+{
+    id = next_id.fetchAndAddOrdered(1);
+}
+
+Arena::~Arena()
+{
+    release();
+}
+
+void *Arena::allocate(size_t size)
+{
+    ArenaLane *lane = threadLane();
+    size = ARENA_ALIGN(size);
+
+    //large allocations get their own block
+    if (size > ARENA_MAX_BLOCK_SIZE/4){
+        char *block = new char[size];
+        lane->blocks.append(block);
+        return block;
+    }
+
+    //blocks grow geometrically so lanes which allocate little do not hold a full block
+    if (size > lane->remaining){
+        size_t block_size = lane->next_block_size;
+        while (block_size < size)
+            block_size *= 2;
+        char *block = new char[block_size];
+        lane->blocks.append(block);
+        lane->pos = block;
+        lane->remaining = block_size;
+        lane->next_block_size = qMin(block_size*2, (size_t)ARENA_MAX_BLOCK_SIZE);
+    }
+    void *ptr = lane->pos;
+    lane->pos += size;
+    lane->remaining -= size;
+    return ptr;
+}
+
+void Arena::release()
+{
+    mutex.lock();
+    for (QHash<int, ArenaLane*>::iterator i = lanes.begin(); i != lanes.end(); ++i){
+        for (int b=0; b<i.value()->blocks.size(); b++)
+            delete [] i.value()->blocks[b];
+        delete i.value();
+    }
+    lanes.clear();
+    id = next_id.fetchAndAddOrdered(1);
+    mutex.unlock();
+}
+
+ArenaLane *Arena::threadLane()
+{
+    if (cached_arena_id == id)
+        return cached_lane;
+
+    //the cache only holds the last arena used by the thread so a thread switching between arenas looks its lane up
+    //(a new lane would start a new block on every switch)
+    if (thread_index < 0)
+        thread_index = next_thread_index.fetchAndAddOrdered(1);
+    mutex.lock();
+    ArenaLane *lane = lanes.value(thread_index, NULL);
+    if (lane == NULL){
+        lane = new ArenaLane();
+        lanes.insert(thread_index, lane);
+    }
+    mutex.unlock();
+    cached_arena_id = id;
+    cached_lane = lane;
+    return lane;
+}
+
+Arena *Arena::current()
+{
+    return current_arena;
+}
+
+void Arena::setCurrent(Arena *arena)
+{
+    current_arena = arena;
+}
+
+
+ArenaScope::ArenaScope(Arena *arena)
+{
+    previous = Arena::current();
+    Arena::setCurrent(arena);
+}
+
+ArenaScope::~ArenaScope()
+{
+    Arena::setCurrent(previous);
+}
+
+
+void *ArenaAllocated::operator new(size_t size)
+{
+    char *ptr;
+    Arena *arena = Arena::current();
+    if (arena){
+        ptr = (char*)arena->allocate(size + ARENA_HEADER_SIZE);
+        *((quint64*)ptr) = ARENA_TAG_ARENA;
+    }else{
+        ptr = (char*)malloc(size + ARENA_HEADER_SIZE);
+        if (ptr == NULL)
+            throw std::bad_alloc();
+        *((quint64*)ptr) = ARENA_TAG_HEAP;
+    }
+    return ptr + ARENA_HEADER_SIZE;
+}
+
+void *ArenaAllocated::operator new[](size_t size)
+{
+    return ArenaAllocated::operator new(size);
+}
+
+void ArenaAllocated::operator delete(void *ptr)
+{
+    if (ptr == NULL)
+        return;
+    char *header = (char*)ptr - ARENA_HEADER_SIZE;
+    if (*((quint64*)header) == ARENA_TAG_HEAP)
+        free(header);
+    //arena memory is freed when the arena is released
+}
+
+void ArenaAllocated::operator delete[](void *ptr)
+{
+    ArenaAllocated::operator delete(ptr);
+}
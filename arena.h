@@ -0,0 +1,61 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QAtomicInt>
+#include <cstddef>
+
+#define ARENA_FIRST_BLOCK_SIZE (4*1024)     //first block of each lane (most lanes of small populations stay small)
+#define ARENA_MAX_BLOCK_SIZE (1024*1024)    //blocks double in size per lane up to this size
+
+class ArenaLane;
+
+//monotonic allocator which owns all model objects created for a population and its sub populations
+//each thread allocates from its own lane so threads do not contend, memory is only freed by release
+class Arena
+{
+public:
+    Arena();
+    ~Arena();
+
+    void *allocate(size_t size);
+    void release();                     //frees all memory (objects must already be destructed)
+
+    static Arena *current();            //arena of the calling thread (NULL if none)
+    static void setCurrent(Arena *arena);
+
+private:
+    ArenaLane *threadLane();
+
+private:
+    QMutex mutex;                       //protects lanes
+    QHash<int, ArenaLane*> lanes;       //one lane per thread (by thread index) until released
+    int id;                             //changes on release so threads do not reuse lanes
+    static QAtomicInt next_id;
+    static QAtomicInt next_thread_index;
+};
+
+//sets the arena of the calling thread for the lifetime of the scope
+class ArenaScope
+{
+public:
+    ArenaScope(Arena *arena);
+    ~ArenaScope();
+private:
+    Arena *previous;
+};
+
+//base class for objects allocated from the current arena (or the heap if there is no current arena)
+//delete runs destructors as normal but arena memory is only freed when the arena is released
+class ArenaAllocated
+{
+public:
+    static void *operator new(size_t size);
+    static void *operator new[](size_t size);
+    static void operator delete(void *ptr);
+    static void operator delete[](void *ptr);
+};
+
+#endif // ARENA_H
@@ -0,0 +1,99 @@
+#include "binaryconnectionfile.h"
+
+#include <QFile>
+#include <QByteArray>
+#include <QtEndian>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#endif
+
+
+BinaryConnectionFile::BinaryConnectionFile(QString filename, uint num_connections, bool explicit_delay)
+{
+    this->filename = filename;
+    this->num_connections = num_connections;
+    this->explicit_delay = explicit_delay;
+    max_src_neuron = 0;
+    max_dst_neuron = 0;
+    open_error = false;
+    size_error = false;
+}
+
+bool BinaryConnectionFile::load()
+{
+    QFile mfile(filename);
+    if (!mfile.open(QFile::ReadOnly)) {
+        open_error = true;
+        return false;
+    }
+
+    qint64 stride = explicit_delay ? 3 : 2;
+    qint64 required_size = num_connections * stride * sizeof(quint32);
+    if (mfile.size() < required_size){
+        size_error = true;
+        return false;
+    }
+    if (num_connections == 0)
+        return true;
+
+    //map the file (read it if mapping is not possible)
+    uchar *mapping = mfile.map(0, required_size);
+    if (mapping){
+#ifdef Q_OS_UNIX
+        madvise(mapping, required_size, MADV_SEQUENTIAL);
+#endif
+        decode(mapping);
+        mfile.unmap(mapping);
+    }else{
+        QByteArray bytes = mfile.read(required_size);
+        if (bytes.size() < required_size){
+            size_error = true;
+            return false;
+        }
+        decode((const uchar*)bytes.constData());
+    }
+    mfile.close();
+
+    return true;
+}
+
+void BinaryConnectionFile::decode(const uchar *data)
+{
+    src_neurons.resize(num_connections);
+    dst_neurons.resize(num_connections);
+    if (explicit_delay)
+        delays.resize(num_connections);
+
+    uint *src = src_neurons.data();
+    uint *dst = dst_neurons.data();
+    uint max_src = 0;
+    uint max_dst = 0;
+    int n = (int)num_connections;
+
+    //byte swap and bounds maxima in one vectorised pass
+    if (explicit_delay){
+        uint *delay = delays.data();
+        #pragma omp parallel for simd reduction(max:max_src,max_dst)
+        for (int i=0; i<n; i++){
+            const uchar *triplet = data + ((qint64)i * 3 * sizeof(quint32));
+            src[i] = qFromBigEndian<quint32>(triplet);
+            dst[i] = qFromBigEndian<quint32>(triplet + sizeof(quint32));
+            delay[i] = qFromBigEndian<quint32>(triplet + 2*sizeof(quint32));
+            max_src = src[i] > max_src ? src[i] : max_src;
+            max_dst = dst[i] > max_dst ? dst[i] : max_dst;
+        }
+    }else{
+        #pragma omp parallel for simd reduction(max:max_src,max_dst)
+        for (int i=0; i<n; i++){
+            const uchar *pair = data + ((qint64)i * 2 * sizeof(quint32));
+            src[i] = qFromBigEndian<quint32>(pair);
+            dst[i] = qFromBigEndian<quint32>(pair + sizeof(quint32));
+            max_src = src[i] > max_src ? src[i] : max_src;
+            max_dst = dst[i] > max_dst ? dst[i] : max_dst;
+        }
+    }
+
+    max_src_neuron = max_src;
+    max_dst_neuron = max_dst;
+}
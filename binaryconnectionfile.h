@@ -0,0 +1,36 @@
+#ifndef BINARYCONNECTIONFILE_H
+#define BINARYCONNECTIONFILE_H
+
+#include <QString>
+#include <QVector>
+
+//bulk loader for ConnectionList binary files (big endian uint triplets of src, dst and optional delay)
+class BinaryConnectionFile
+{
+public:
+    BinaryConnectionFile(QString filename, uint num_connections, bool explicit_delay);
+
+    bool load(); //false if the file could not be opened or is too short
+
+public:
+    QString filename;
+    uint num_connections;
+    bool explicit_delay;
+
+    //contiguous connection data
+    QVector<uint> src_neurons;
+    QVector<uint> dst_neurons;
+    QVector<uint> delays;       //empty if no explicit delay
+
+    //maximum neuron indices (for bounds checking)
+    uint max_src_neuron;
+    uint max_dst_neuron;
+
+    bool open_error;
+    bool size_error;
+
+private:
+    void decode(const uchar *data);
+};
+
+#endif // BINARYCONNECTIONFILE_H
@@ -0,0 +1,43 @@
+#include "fanoutwriter.h"
+
+
+FanOutWriter::FanOutWriter()
+    : SpineMLWriter()
+{
+}
+
+FanOutWriter::~FanOutWriter()
+{
+    for (int i=0; i<writers.size(); i++)
+        delete writers[i];
+}
+
+void FanOutWriter::addWriter(SpineMLWriter *writer)
+{
+    writers.append(writer);
+}
+
+void FanOutWriter::writeDocumentStart()
+{
+    for (int i=0; i<writers.size(); i++)
+        writers[i]->writeDocumentStart();
+}
+
+void FanOutWriter::writeDocuemntEnd()
+{
+    for (int i=0; i<writers.size(); i++)
+        writers[i]->writeDocuemntEnd();
+}
+
+void FanOutWriter::writePopulation(Population *sub_population, Population *population)
+{
+    //populations are written to each writer in turn (writers only read the population)
+    for (int i=0; i<writers.size(); i++)
+        writers[i]->writePopulation(sub_population, population);
+}
+
+void FanOutWriter::close()
+{
+    for (int i=0; i<writers.size(); i++)
+        writers[i]->close();
+}
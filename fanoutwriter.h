@@ -0,0 +1,27 @@
+#ifndef FANOUTWRITER_H
+#define FANOUTWRITER_H
+
+#include <QList>
+#include "writer.h"
+
+//writes each split population to several writers (the outputs of experiments which share a network in batch mode)
+class FanOutWriter : public SpineMLWriter
+{
+public:
+    FanOutWriter();
+    ~FanOutWriter();
+
+    void addWriter(SpineMLWriter *writer);     //owned (deleted by the fan out writer)
+
+    void writeDocumentStart();
+    void writeDocuemntEnd();
+
+    void writePopulation(Population *sub_population, Population *population = NULL);
+
+    void close();
+
+private:
+    QList<SpineMLWriter*> writers;
+};
+
+#endif // FANOUTWRITER_H
@@ -16,6 +16,11 @@ InfoParser::InfoParser(QXmlStreamReader *xml_src)
     xml = xml_src;
     population_count = 1;
     sub_population_count = 1;
+    header_length = 0;
+    header_lines = 0;
+    byte_offsets = false;
+    default_partition_size = MAX_POPULATION_SIZE;
+    node_count = 1;
 }
 
 InfoParser::~InfoParser()
@@ -38,9 +43,16 @@ void InfoParser::parse()
         std::cerr << "Error (line " << xml->lineNumber() << "): XML model file is not a SpineML LL document!" << std::endl;
         exit(0);
     }
+    header_length = xml->characterOffset();
+    header_lines = xml->lineNumber();
+    byte_offsets = false;
+    population_ranges.clear();
+
+    qint64 element_start = xml->characterOffset();
+    qint64 element_line = xml->lineNumber();
     while (xml->readNextStartElement()) {
          if (xml->name() == "Population"){
-             parsePopulationInfo();
+             parsePopulationInfo(element_start, element_line);
          }
          else if (xml->name() == "ComponenentInstance"){
              std::cerr << "Error (line " << xml->lineNumber() << "): XML model file contains groups. These must be converted to populations!" << std::endl;
@@ -48,10 +60,17 @@ void InfoParser::parse()
          }
          else
              xml->skipCurrentElement();
+         element_start = xml->characterOffset();
+         element_line = xml->lineNumber();
     }
     if (INFO_PARSER_DEBUG_OUTPUT)
         qDebug() << "*** End Info Parsing";
 
+    calculateDimensions();
+}
+
+void InfoParser::calculateDimensions()
+{
     //update dimensions of weightupdate and postsynapses information
     for (int i=0; i<component_info.values().size(); i++){
         ComponentInfo *info  = component_info.values()[i];
@@ -72,7 +91,7 @@ void InfoParser::parse()
 
 
 
-void InfoParser::parsePopulationInfo()
+void InfoParser::parsePopulationInfo(qint64 char_start, qint64 line_start)
 {
     //sanity check
     Q_ASSERT(xml->isStartElement() && xml->name() == "Population");
@@ -98,6 +117,12 @@ void InfoParser::parsePopulationInfo()
             xml->skipCurrentElement();
     }
 
+    //record range for parallel full parsing
+    PopulationRange range;
+    range.char_start = char_start;
+    range.char_end = xml->characterOffset();
+    range.line_start = line_start;
+    population_ranges.append(range);
 }
 
 ComponentInfo *InfoParser::parseNeuronInfo()
@@ -107,14 +132,7 @@ ComponentInfo *InfoParser::parseNeuronInfo()
     if (INFO_PARSER_DEBUG_OUTPUT)
         qDebug() << "Info Parser: Found neuron on line " << xml->lineNumber();
 
-    PopulationInfo *pop_info = new PopulationInfo();
-
-    pop_info->name = Parser::getStringAttribute(xml, "name");
-    pop_info->size = Parser::getIntAttribute(xml, "size");
-    pop_info->global_index = population_count++;
-    pop_info->global_sub_start_index = sub_population_count;
-    pop_info->splits = UINT_DIV_CEIL(pop_info->size, MAX_POPULATION_SIZE);
-    sub_population_count += pop_info->splits;
+    PopulationInfo *pop_info = createPopulationInfo(Parser::getStringAttribute(xml, "name"), Parser::getIntAttribute(xml, "size"));
 
     if (component_info.contains(pop_info->name)){
         std::cerr << "Error (line " << xml->lineNumber() << "): Duplicate component name '" <<  pop_info->name.toLocal8Bit().data() << "' found in model file." << std::endl;
@@ -145,30 +163,7 @@ void InfoParser::parseProjectionInfo(ComponentInfo *population_info)
     if (INFO_PARSER_DEBUG_OUTPUT)
         qDebug() << "Info Parser: Found projection on line " << xml->lineNumber();
 
-    QString proj_population = Parser::getStringAttribute(xml, "dst_population", true);
-
-    //set mode and check for consistency
-    if (proj_population == ""){
-        proj_population = Parser::getStringAttribute(xml, "src_population");
-        if (proj_population == ""){
-            std::cerr << "Error (line " << xml->lineNumber() << "): No dst_population or src_population atrribute in 'Projection' element." << std::endl;
-            exit(0);
-        }else{
-            //set src mode
-            if (splitter_mode == SPLITMODE_PROJ_DEF_AT_SRC){
-                std::cerr << "Error (line " << xml->lineNumber() << "): Projections using src_population and dst_population can not be mixed within the same network layer document." << std::endl;
-                exit(0);
-            }
-            splitter_mode = SPLITMODE_PROJ_DEF_AT_DST;
-        }
-    }else{
-        //set dst mode
-        if (splitter_mode == SPLITMODE_PROJ_DEF_AT_DST){
-            std::cerr << "Error (line " << xml->lineNumber() << "): Projections using src_population and dst_population can not be mixed within the same network layer document." << std::endl;
-            exit(0);
-        }
-        splitter_mode = SPLITMODE_PROJ_DEF_AT_SRC;
-    }
+    QString proj_population = parseProjectionPopulation(xml);
 
     while (xml->readNextStartElement()) {
         if (xml->name() == "Synapse"){
@@ -200,6 +195,7 @@ void InfoParser::parseSynapseInfo(QString population_name, QString proj_populati
         //create synpase info
         WeightUpdateInfo *info = new WeightUpdateInfo();
         info->name = Parser::getStringAttribute(xml, "name");
+        info->population = population_name;
         info->projPopulation = proj_population;
         info->size = 0;     // Size ignored as this will be calculated after full info parse!
         info->srcPopSize = src_pop_size;
@@ -252,7 +248,7 @@ void InfoParser::parseSynapseInfo(QString population_name, QString proj_populati
         //parse any inputs
         while (xml->readNextStartElement()) {
             if (xml->name() == "Input"){
-                parseInput(population_name, true);
+                parseInput(population_name, true, (splitter_mode == SPLITMODE_PROJ_DEF_AT_SRC) ? proj_population : population_name);
             }
             else
                 xml->skipCurrentElement();
@@ -267,7 +263,7 @@ void InfoParser::parseSynapseInfo(QString population_name, QString proj_populati
 
 }
 
-void InfoParser::parseInput(QString src_name, bool ps_input)
+void InfoParser::parseInput(QString src_name, bool ps_input, QString dst_population)
 {
     //sanity check
     Q_ASSERT(xml->isStartElement() && xml->name() == "Input");
@@ -278,18 +274,23 @@ void InfoParser::parseInput(QString src_name, bool ps_input)
     //atributes
     QString src = Parser::getStringAttribute(xml, "src");
     QString src_port = Parser::getStringAttribute(xml, "src_port");
-    bool ignore = false;
+
+    //connectivity
+    uint explicit_connections = 0;
+    ConnectivityType connection_type = parseConnectivityInfo(&explicit_connections);
 
     //ignore self inputs between PS and neuron where there is a one to one corellation (DAMSON specific)
-    if ((ps_input)&&(src_name == src)){
-        xml->readNextStartElement();    //connectivity
-        if (xml->name() == "OneToOneConnection")
-            ignore = true;
-        xml->skipCurrentElement();      //skip out of connectivity
-    }
+    bool ignore = (ps_input)&&(src_name == src)&&(connection_type == ONE_TO_ONE_CONNECTVITY_TYPE);
 
-    if (!ignore)
+    if (!ignore){
         port_inputs.insertMulti(src, src_port);
+        InputInfo info;
+        info.src = src;
+        info.dst_population = dst_population.isEmpty() ? src_name : dst_population;
+        info.connectivity = connection_type;
+        info.connectionListCount = explicit_connections;
+        input_info.append(info);
+    }
 
     xml->skipCurrentElement(); //skip out of input
 }
@@ -300,20 +301,15 @@ ConnectivityType InfoParser::parseConnectivityInfo(uint *connection_instances_co
     *connection_instances_count = 0;
     xml->readNextStartElement();
     if (xml->name() == "ConnectionList"){
+        //every child is skipped so the loop ends at the end of the connection list
         while (xml->readNextStartElement()) {
-            if (xml->name() == "BinaryFile"){
-                (*connection_instances_count) = Parser::getIntAttribute(xml, "num_connections");
-                xml->skipCurrentElement();
-                break;
-            }
-            else if (xml->name() == "Connection"){
+            if (xml->name() == "BinaryFile")
+                (*connection_instances_count) += Parser::getIntAttribute(xml, "num_connections");
+            else if (xml->name() == "Connection")
                 (*connection_instances_count)++;
-            }
-            else
-                xml->skipCurrentElement();
-
+            xml->skipCurrentElement();
         }
-        type = LIST_CONNECTVITY_TYPE;
+        return LIST_CONNECTVITY_TYPE;
     }else if (xml->name() == "OneToOneConnection") {
         //xml->skipCurrentElement();
         type = ONE_TO_ONE_CONNECTVITY_TYPE;
@@ -332,11 +328,194 @@ ConnectivityType InfoParser::parseConnectivityInfo(uint *connection_instances_co
     return type;
 }
 
+QString InfoParser::parseProjectionPopulation(QXmlStreamReader *xml_proj)
+{
+    //sanity check
+    Q_ASSERT(xml_proj->isStartElement() && xml_proj->name() == "Projection");
+
+    QString proj_population = Parser::getStringAttribute(xml_proj, "dst_population", true);
+
+    //set mode and check for consistency
+    if (proj_population == ""){
+        proj_population = Parser::getStringAttribute(xml_proj, "src_population");
+        if (proj_population == ""){
+            std::cerr << "Error (line " << xml_proj->lineNumber() << "): No dst_population or src_population atrribute in 'Projection' element." << std::endl;
+            exit(0);
+        }else{
+            //set src mode
+            if (splitter_mode == SPLITMODE_PROJ_DEF_AT_SRC){
+                std::cerr << "Error (line " << xml_proj->lineNumber() << "): Projections using src_population and dst_population can not be mixed within the same network layer document." << std::endl;
+                exit(0);
+            }
+            splitter_mode = SPLITMODE_PROJ_DEF_AT_DST;
+        }
+    }else{
+        //set dst mode
+        if (splitter_mode == SPLITMODE_PROJ_DEF_AT_DST){
+            std::cerr << "Error (line " << xml_proj->lineNumber() << "): Projections using src_population and dst_population can not be mixed within the same network layer document." << std::endl;
+            exit(0);
+        }
+        splitter_mode = SPLITMODE_PROJ_DEF_AT_SRC;
+    }
+
+    return proj_population;
+}
+
+PopulationInfo *InfoParser::createPopulationInfo(QString name, uint size)
+{
+    PopulationInfo *pop_info = new PopulationInfo();
+
+    pop_info->name = name;
+    pop_info->size = size;
+    pop_info->global_index = population_count++;
+    pop_info->global_sub_start_index = sub_population_count;
+    if (node_count > 1)
+        pop_info->partition.setHierarchical(pop_info->size, node_count, partition_sizes.value(name, default_partition_size));
+    else
+        pop_info->partition.setUniform(pop_info->size, partition_sizes.value(name, default_partition_size));
+    sub_population_count += pop_info->partition.count();
+
+    return pop_info;
+}
+
+void InfoParser::addParsedComponentInfo(ComponentInfo *info)
+{
+    if (component_info.contains(info->name)){
+        std::cerr << "Error: Duplicate component name '" <<  info->name.toLocal8Bit().data() << "' found in model file." << std::endl;
+        exit(0);
+    }
+    component_info[info->name] = info;
+}
+
+void InfoParser::addParsedPopulation(Population *population)
+{
+    //builds the same component information as parsePopulationInfo but from an already (fully) parsed population (single pass parsing)
+    Neuron *neuron = population->neuron;
+    PopulationInfo *pop_info = createPopulationInfo(neuron->name, neuron->size);
+    addParsedComponentInfo((ComponentInfo*)pop_info);
+
+    //neuron inputs
+    for (QHash<QString, Input*>::const_iterator i = neuron->inputs.constBegin(); i != neuron->inputs.constEnd(); ++i){
+        port_inputs.insertMulti(i.value()->src, i.value()->src_port);
+        addParsedInputInfo(i.value(), neuron->name);
+    }
+
+    //projections
+    for (QHash<QString, Projection*>::const_iterator p = population->projections.constBegin(); p != population->projections.constEnd(); ++p){
+        Projection *projection = p.value();
+        for (QHash<QString, Synapse*>::const_iterator s = projection->synapses.constBegin(); s != projection->synapses.constEnd(); ++s){
+            Synapse *synapse = s.value();
+
+            //weight update info (sizes of the projection population are calculated by calculateDimensions)
+            WeightUpdateInfo *wu_info = new WeightUpdateInfo();
+            wu_info->name = synapse->weightupdate->name;
+            wu_info->population = neuron->name;
+            wu_info->projPopulation = projection->proj_population;
+            wu_info->size = 0;
+            if (splitter_mode == SPLITMODE_PROJ_DEF_AT_SRC){
+                wu_info->srcPopSize = neuron->size;
+                wu_info->dstPopSize = 0;
+            }else{
+                wu_info->srcPopSize = 0;
+                wu_info->dstPopSize = neuron->size;
+            }
+            wu_info->connectivity = synapse->connection->Type();
+            wu_info->connectionListCount = 0;
+            if (wu_info->connectivity == LIST_CONNECTVITY_TYPE)
+                wu_info->connectionListCount = ((ConnectionList*)synapse->connection)->size();
+            addParsedComponentInfo((ComponentInfo*)wu_info);
+            if (splitter_mode == SPLITMODE_PROJ_DEF_AT_SRC)
+                port_inputs.insertMulti(neuron->name, synapse->weightupdate->input_src_port);
+            else
+                port_inputs.insertMulti(projection->proj_population, synapse->weightupdate->input_src_port);
+
+            //postsynapse info
+            PostsynapseInfo *ps_info = new PostsynapseInfo();
+            ps_info->name = synapse->postsynapse->name;
+            ps_info->projPopulation = projection->proj_population;
+            ps_info->size = wu_info->dstPopSize;
+            addParsedComponentInfo((ComponentInfo*)ps_info);
+
+            //postsynapse inputs (ignore self inputs with one to one remapping as in parseInput)
+            for (QHash<QString, Input*>::const_iterator i = synapse->postsynapse->inputs.constBegin(); i != synapse->postsynapse->inputs.constEnd(); ++i){
+                Input *input = i.value();
+                if ((input->src == neuron->name)&&(input->remapping->Type() == ONE_TO_ONE_CONNECTVITY_TYPE))
+                    continue;
+                port_inputs.insertMulti(input->src, input->src_port);
+                addParsedInputInfo(input, (splitter_mode == SPLITMODE_PROJ_DEF_AT_SRC) ? projection->proj_population : neuron->name);
+            }
+        }
+    }
+}
+
+void InfoParser::addParsedInputInfo(Input *input, QString dst_population)
+{
+    InputInfo info;
+    info.src = input->src;
+    info.dst_population = dst_population;
+    info.connectivity = input->remapping->Type();
+    info.connectionListCount = 0;
+    if (info.connectivity == LIST_CONNECTVITY_TYPE)
+        info.connectionListCount = ((ConnectionList*)input->remapping)->size();
+    input_info.append(info);
+}
+
 SplitterMode InfoParser::getSplitterMode()
 {
     return splitter_mode;
 }
 
+void InfoParser::setSplitterMode(SplitterMode splitter_mode)
+{
+    this->splitter_mode = splitter_mode;
+}
+
+void InfoParser::copyInfo(InfoParser *source)
+{
+    for (int i=0; i<component_info.values().size(); i++)
+        delete component_info.values()[i];
+    component_info.clear();
+
+    //component info is copied so the source is unchanged by later splits (e.g. balanced partitions)
+    for (QHash<QString, ComponentInfo*>::const_iterator i = source->component_info.constBegin(); i != source->component_info.constEnd(); ++i){
+        ComponentInfo *info = i.value();
+        switch (info->Type()){
+            case(COMPONENT_TYPE_POPULATION):{
+                component_info.insert(i.key(), new PopulationInfo(*(PopulationInfo*)info));
+                break;
+            }
+            case(COMPONENT_TYPE_WEIGHT_UPDATE):{
+                component_info.insert(i.key(), new WeightUpdateInfo(*(WeightUpdateInfo*)info));
+                break;
+            }
+            case(COMPONENT_TYPE_POSTSYNAPSE):{
+                component_info.insert(i.key(), new PostsynapseInfo(*(PostsynapseInfo*)info));
+                break;
+            }
+            default:{
+                break;
+            }
+        }
+    }
+    splitter_mode = source->splitter_mode;
+    port_inputs = source->port_inputs;
+    population_count = source->population_count;
+    sub_population_count = source->sub_population_count;
+    population_ranges = source->population_ranges;
+    input_info = source->input_info;
+    header_length = source->header_length;
+    header_lines = source->header_lines;
+    byte_offsets = source->byte_offsets;
+    default_partition_size = source->default_partition_size;
+    partition_sizes = source->partition_sizes;
+    node_count = source->node_count;
+}
+
+bool InfoParser::isPartitionedAs(InfoParser *other)
+{
+    return (default_partition_size == other->default_partition_size) && (partition_sizes == other->partition_sizes) && (node_count == other->node_count);
+}
+
 void InfoParser::addPopulationInfo(PopulationInfo *pop_info)
 {
     if (component_info.contains(pop_info->name)){
@@ -348,12 +527,69 @@ void InfoParser::addPopulationInfo(PopulationInfo *pop_info)
 
 ComponentInfo *InfoParser::getComponentInfo(QString name)
 {
-    return component_info[name];
+    return component_info.value(name);
+}
+
+void InfoParser::setPartitionSizes(uint default_partition_size, const QHash<QString, uint> &partition_sizes)
+{
+    //must be set before parsing as population splits are calculated when the population info is created
+    this->default_partition_size = default_partition_size;
+    this->partition_sizes = partition_sizes;
+}
+
+void InfoParser::setNodeCount(uint node_count)
+{
+    //must be set before parsing for the same reason as partition sizes
+    this->node_count = node_count;
+}
+
+uint InfoParser::getPartitionSize(QString name)
+{
+    //populations have their own partition size, other components use the default
+    ComponentInfo* info = component_info.value(name);
+    if ((info) && (info->Type() == COMPONENT_TYPE_POPULATION))
+        return ((PopulationInfo*)info)->partition.max_size;
+    return partition_sizes.value(name, default_partition_size);
+}
+
+PopulationPartition InfoParser::getPartition(QString name)
+{
+    //components other than populations are partitioned uniformly (within node partitions if hierarchical)
+    ComponentInfo* info = component_info.value(name);
+    if ((info) && (info->Type() == COMPONENT_TYPE_POPULATION))
+        return ((PopulationInfo*)info)->partition;
+    PopulationPartition partition;
+    if (node_count > 1)
+        partition.setHierarchical(info ? info->size : 0, node_count, partition_sizes.value(name, default_partition_size));
+    else
+        partition.setUniform(info ? info->size : 0, partition_sizes.value(name, default_partition_size));
+    return partition;
+}
+
+void InfoParser::setPopulationPartition(QString pop_name, const QVector<uint> &offsets)
+{
+    //replaces the uniform partition of a population (before any population is split)
+    PopulationInfo *pop_info = getPopulationInfo(pop_name);
+    pop_info->partition.setOffsets(offsets, pop_info->partition.max_size);
+
+    //sub population (alias) numbering follows the population order
+    QVector<PopulationInfo*> populations(population_count, NULL);
+    for (QHash<QString, ComponentInfo*>::const_iterator i = component_info.constBegin(); i != component_info.constEnd(); ++i){
+        if (i.value()->Type() == COMPONENT_TYPE_POPULATION)
+            populations[((PopulationInfo*)i.value())->global_index] = (PopulationInfo*)i.value();
+    }
+    sub_population_count = 1;
+    for (int i=0; i<populations.size(); i++){
+        if (populations[i]){
+            populations[i]->global_sub_start_index = sub_population_count;
+            sub_population_count += populations[i]->partition.count();
+        }
+    }
 }
 
 PopulationInfo *InfoParser::getPopulationInfo(QString pop_name)
 {
-    ComponentInfo* info = component_info[pop_name];
+    ComponentInfo* info = component_info.value(pop_name);
     if(info->Type() == COMPONENT_TYPE_POPULATION)
     {
         return (PopulationInfo*)info;
@@ -409,6 +645,41 @@ QList<QString> InfoParser::getActiveSourcePorts(QString population_name)
     return port_inputs.values(population_name);
 }
 
+const QVector<PopulationRange> &InfoParser::getPopulationRanges()
+{
+    return population_ranges;
+}
+
+QList<ComponentInfo*> InfoParser::getComponentInfoList()
+{
+    return component_info.values();
+}
+
+const QList<InputInfo> &InfoParser::getInputInfo()
+{
+    return input_info;
+}
+
+qint64 InfoParser::getHeaderLength()
+{
+    return header_length;
+}
+
+qint64 InfoParser::getHeaderLines()
+{
+    return header_lines;
+}
+
+void InfoParser::setByteOffsets(bool byte_offsets)
+{
+    this->byte_offsets = byte_offsets;
+}
+
+bool InfoParser::hasByteOffsets()
+{
+    return byte_offsets;
+}
+
 bool InfoParser::componentExists(QString name)
 {
     return component_info.contains(name);
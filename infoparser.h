@@ -13,6 +13,15 @@ typedef enum
     SPLITMODE_PROJ_DEF_AT_DST
 }SplitterMode;
 
+//character range of a population element within the network file (recorded during the info parse)
+class PopulationRange
+{
+public:
+    qint64 char_start;      //end of the preceeding token (only whitespace or comments before the population element)
+    qint64 char_end;        //end of the population end element
+    qint64 line_start;      //line of char_start
+};
+
 class InfoParser
 {
 public:
@@ -21,25 +30,49 @@ public:
 
 public:
     void parse();
+    void calculateDimensions();
+    void addParsedPopulation(Population *population);
+    QString parseProjectionPopulation(QXmlStreamReader *xml_proj);
     ComponentInfo *getComponentInfo(QString name);
     PopulationInfo *getPopulationInfo(QString pop_name);
     PopulationInfo *getUnsplitPopulationInfo(QString sub_pop_name);
     uint getSubPopulationIndex(QString sub_pop_name);
     QList<QString> getActiveSourcePorts(QString population_name);
 
+    const QVector<PopulationRange> &getPopulationRanges();
+    QList<ComponentInfo*> getComponentInfoList();
+    const QList<InputInfo> &getInputInfo();
+    qint64 getHeaderLength();
+    qint64 getHeaderLines();
+    void setByteOffsets(bool byte_offsets);     //set once the document read by parse() is known to be ascii
+    bool hasByteOffsets();                      //population ranges are also byte offsets of the document
+
     bool componentExists(QString name);
     SplitterMode getSplitterMode();
+    void setSplitterMode(SplitterMode splitter_mode);   //for populations not parsed from a document
+
+    void setPartitionSizes(uint default_partition_size, const QHash<QString, uint> &partition_sizes);
+    void setNodeCount(uint node_count);     //node partitions of every population (1 for a single level split)
+    uint getPartitionSize(QString name);
+    PopulationPartition getPartition(QString name);
+    void setPopulationPartition(QString pop_name, const QVector<uint> &offsets);
 
     void addPopulationInfo(PopulationInfo *pop_info);
 
+    void copyInfo(InfoParser *source);              //replaces the tables with copies of the tables of the source (cached info)
+    bool isPartitionedAs(InfoParser *other);        //same default and per population partition sizes and node count
+
 protected:
     //population info parsing
-    void parsePopulationInfo();
+    void parsePopulationInfo(qint64 char_start, qint64 line_start);
     ComponentInfo* parseNeuronInfo();
     void parseProjectionInfo(ComponentInfo* population_info);
     void parseSynapseInfo(QString population_name, QString proj_population, uint src_pop_size, uint dst_pop_size);
-    void parseInput(QString src_name, bool ps_input=false);
+    void parseInput(QString src_name, bool ps_input=false, QString dst_population=QString());
     ConnectivityType parseConnectivityInfo(uint *connection_instances_count);
+    PopulationInfo* createPopulationInfo(QString name, uint size);
+    void addParsedComponentInfo(ComponentInfo *info);
+    void addParsedInputInfo(Input *input, QString dst_population);
 
 private:
     SplitterMode splitter_mode;
@@ -48,6 +81,14 @@ private:
     QHash<QString, QString> port_inputs; //ports used by inputs and projections by source name (one to many)
     uint population_count;
     uint sub_population_count;
+    QVector<PopulationRange> population_ranges; //document order
+    QList<InputInfo> input_info;
+    qint64 header_length;                       //characters up to the end of the SpineML start element
+    qint64 header_lines;
+    bool byte_offsets;                          //character offsets are byte offsets (ascii document)
+    uint default_partition_size;                //maximum sub population size
+    QHash<QString, uint> partition_sizes;       //maximum sub population size by population name (overrides default)
+    uint node_count;                            //node partitions of each population (sub populations are split within nodes)
 };
 
 #endif // INFOPARSER_H
@@ -3,15 +3,92 @@
 #include <QElapsedTimer>
 #include <QDebug>
 
+#include <QCoreApplication>
+#include <QStringList>
+#include <QFileInfo>
+
 #include "splitter.h"
+#include "splitdaemon.h"
+#include "partitioner.h"
+
+//options of one split (from the command line or from a daemon request)
+class SplitOptions
+{
+public:
+    SplitOptions();
+
+public:
+    bool parallel;
+    bool formatting;
+    bool silent;
+    bool single_pass;
+    bool mapped_input;
+    uint partition_size;
+    QString partition_file;
+    uint node_count;
+    bool balanced;
+    bool reordered;
+    bool pipelined;
+    bool materialised;
+    bool sampled;
+    bool streamed;
+    bool planned;
+    WriterMode mode;
+};
+
+SplitOptions::SplitOptions()
+{
+    parallel = true;
+    formatting = true;
+    silent = false;
+    single_pass = false;
+    mapped_input = false;
+    partition_size = MAX_POPULATION_SIZE;
+    node_count = 1;
+    balanced = false;
+    reordered = false;
+    pipelined = false;
+    materialised = false;
+    sampled = false;
+    streamed = false;
+    planned = false;
+    mode = WRITER_MODE_XML;
+}
 
 void printUsage(){
     std::cout << "Usage: SpineMLSplitter input_file output_file [options]" << std::endl;
+    std::cout << "       SpineMLSplitter -batch manifest_file [options]" << std::endl;
+    std::cout << "       SpineMLSplitter -daemon socket_name [-silent]" << std::endl;
     std::cout << "Options:" << std::endl;
     std::cout << "   -no_parallel        Turns off multicore splitting optimisations" << std::endl;
     std::cout << "   -no_xml_formatting  Turns off xml autoformatting in default xml output (ignored when -alias is used)" << std::endl;
     std::cout << "   -alias              Writes split file to DAMSON alias file (ignores no_xml_formatting)" << std::endl;
     std::cout << "   -silent             Turns off console reporting of splitter and writer progress" << std::endl;
+    std::cout << "   -mmap               Memory maps the experiment and network input files (populations are then parsed in parallel)" << std::endl;
+    std::cout << "   -single_pass        Parses the network in a single pass (holds all populations in memory)" << std::endl;
+    std::cout << "   -partition_size n   Maximum sub population size (default " << MAX_POPULATION_SIZE << ")" << std::endl;
+    std::cout << "   -partition_file f   File of 'population_name size' lines overriding the partition size of named populations" << std::endl;
+    std::cout << "   -nodes n            Splits each population into n node partitions then each node partition into sub populations of" << std::endl;
+    std::cout << "                       the partition size. Node k of every population shares a node. The node of each sub population is" << std::endl;
+    std::cout << "                       written to output_file.nodes (not supported with -balance or -stream)" << std::endl;
+    std::cout << "   -balance            Balances the estimated work of sub populations rather than splitting uniformly (implies -single_pass)." << std::endl;
+    std::cout << "                       Skewed populations may use up to " << PARTITION_MAX_PART_FACTOR << "x the uniform number of sub populations (cores)" << std::endl;
+    std::cout << "   -reorder            Renumbers neurons to cluster list connectivity within sub populations and writes the permutation to output_file.permutation (implies -single_pass)" << std::endl;
+    std::cout << "   -pipeline           Parses, splits and writes consecutive populations concurrently (ignored with -single_pass)" << std::endl;
+    std::cout << "   -materialise        Generates explicit connection lists for fixed probability connectivity, written to binary files alongside output_file (not supported with -alias)" << std::endl;
+    std::cout << "   -sample             Samples stochastic property values into value lists of each sub component (reproducible for any partition or thread count)" << std::endl;
+    std::cout << "   -stream             Writes and frees sub populations as they are split so peak memory is one window of sub populations (ignored with -pipeline)" << std::endl;
+    std::cout << "   -plan               Reports how the model will split from the info parse only (nothing is written to output_file)" << std::endl;
+    std::cout << "Batch:" << std::endl;
+    std::cout << "   -batch manifest_file Splits the experiments of a manifest of 'experiment_file output_file' lines (tab separated" << std::endl;
+    std::cout << "                       if the paths contain spaces). Experiments sharing a network are split once and written to" << std::endl;
+    std::cout << "                       each of their output files" << std::endl;
+    std::cout << "Daemon:" << std::endl;
+    std::cout << "   -daemon socket_name Stays resident and splits requests received on a local socket. Each request is one line of" << std::endl;
+    std::cout << "                       tab separated 'input_file output_file [options]' answered by a line starting OK or ERROR." << std::endl;
+    std::cout << "                       Info parses, binary connection files and definitions are cached while their files are" << std::endl;
+    std::cout << "                       unchanged ('stats' reports the cache, 'shutdown' stops the daemon). Requests are split by a" << std::endl;
+    std::cout << "                       worker process so a failed request is answered by ERROR (and restarts the worker and cache)" << std::endl;
 }
 
 QString formatMillis(uint ms){
@@ -23,13 +100,131 @@ QString formatMillis(uint ms){
     return format;
 }
 
+bool parseOptions(const QStringList &arguments, SplitOptions &options, QString &error)
+{
+    //arguments following the input and output files
+    for (int i=0; i<arguments.size(); i++){
+        QString arg = arguments[i];
+        if (arg == "-no_parallel")
+            options.parallel = false;
+        else if (arg == "-no_xml_formatting")
+            options.formatting = false;
+        else if (arg == "-silent")
+            options.silent = true;
+        else if (arg == "-alias")
+            options.mode = WRITER_MODE_ALIAS;
+        else if (arg == "-graph")
+            options.mode = WRITER_MODE_GRAPH;
+        else if (arg == "-single_pass")
+            options.single_pass = true;
+        else if (arg == "-mmap")
+            options.mapped_input = true;
+        else if ((arg == "-partition_size") && (i+1 < arguments.size())){
+            bool ok = false;
+            options.partition_size = arguments[++i].toUInt(&ok);
+            if ((!ok) || (options.partition_size == 0)){
+                error = "Invalid partition size!";
+                return false;
+            }
+        }
+        else if ((arg == "-partition_file") && (i+1 < arguments.size()))
+            options.partition_file = arguments[++i];
+        else if ((arg == "-nodes") && (i+1 < arguments.size())){
+            bool ok = false;
+            options.node_count = arguments[++i].toUInt(&ok);
+            if ((!ok) || (options.node_count == 0)){
+                error = "Invalid node count!";
+                return false;
+            }
+        }
+        else if (arg == "-balance")
+            options.balanced = true;
+        else if (arg == "-reorder")
+            options.reordered = true;
+        else if (arg == "-pipeline")
+            options.pipelined = true;
+        else if (arg == "-materialise")
+            options.materialised = true;
+        else if (arg == "-sample")
+            options.sampled = true;
+        else if (arg == "-stream")
+            options.streamed = true;
+        else if (arg == "-plan")
+            options.planned = true;
+        else{
+            error = "Unrecognised argument!";
+            return false;
+        }
+    }
+    return true;
+}
+
+QString incompatibleOptions(const SplitOptions &options)
+{
+    //empty if the options can be combined
+    if (options.materialised && (options.mode == WRITER_MODE_ALIAS))
+        return "Materialised fixed probability connectivity is not supported by the alias writer!";
+    if ((options.node_count > 1) && (options.balanced || options.streamed))
+        return "Hierarchical splitting (-nodes) is not supported with -balance or -stream!";
+    return QString();
+}
+
+SpineMLSplitter *createSplitter(const SplitOptions &options)
+{
+    SpineMLSplitter *splitter = new SpineMLSplitter(options.parallel, options.formatting, options.silent, options.mode);
+    splitter->setSinglePass(options.single_pass);
+    splitter->setMappedInput(options.mapped_input);
+    splitter->setPartitionSize(options.partition_size);
+    splitter->setPartitionFile(options.partition_file);
+    splitter->setNodeCount(options.node_count);
+    splitter->setBalanced(options.balanced);
+    splitter->setReordered(options.reordered);
+    splitter->setPipelined(options.pipelined);
+    splitter->setMaterialiseFixedProbability(options.materialised);
+    splitter->setSampledProperties(options.sampled);
+    splitter->setStreamed(options.streamed);
+    splitter->setPlanned(options.planned);
+    return splitter;
+}
+
+bool splitRequest(const QStringList &arguments, SplitCache *cache, QString &reply)
+{
+    //split of a daemon request in the worker process (errors within the split end the worker, not the daemon)
+    SplitOptions options;
+    if (arguments.size() < 2){
+        reply = "Expected 'input_file output_file [options]'";
+        return false;
+    }
+    if (!parseOptions(arguments.mid(2), options, reply))
+        return false;
+    reply = incompatibleOptions(options);
+    if (!reply.isEmpty())
+        return false;
+    if (!QFileInfo(arguments[0]).isFile()){
+        reply = QString("Could not find input file '%1'").arg(arguments[0]);
+        return false;
+    }
+
+    SpineMLSplitter *splitter = createSplitter(options);
+    splitter->setCache(cache);
+    splitter->split(arguments[0], arguments[1]);
+
+    reply = QString("%1 ms, %2 sub populations, %3 sub projections/inputs").arg(splitter->getTotalTime())
+            .arg(splitter->getSplitPopulationCount()).arg(splitter->getSplitProjectionCount()+splitter->getSplitInputCount());
+    delete splitter;
+    return true;
+}
+
 int main(int argc, char** argv)
 {
     SpineMLSplitter *splitter;
-    bool parallel = true;
-    bool formatting = true;
-    bool silent = false;
-    WriterMode mode = WRITER_MODE_XML;
+    SplitOptions options;
+
+    //worker process of a resident splitter (started by the daemon)
+    if ((argc == 2) && (QString(argv[1]) == DAEMON_WORKER_ARGUMENT)){
+        QCoreApplication app(argc, argv);
+        return SplitDaemon::runWorker(splitRequest);
+    }
 
     //check argument count
     if (argc < 3){
@@ -37,33 +232,47 @@ int main(int argc, char** argv)
         exit(0);
     }
 
-    //handle arguments
+    //resident splitter
+    if (QString(argv[1]) == "-daemon"){
+        QCoreApplication app(argc, argv);
+        bool silent = (argc > 3) && (QString(argv[3]) == "-silent");
+        SplitDaemon daemon(QString(argv[2]), silent);
+        if (!daemon.listen())
+            exit(0);
+        daemon.run();
+        return 0;
+    }
+
+    //handle arguments (the manifest file takes the place of the output file in batch mode)
     QString input_file = QString(argv[1]);
     QString output_file = QString(argv[2]);
-    for (int i=3; i<argc; i++){
-        QString arg = QString(argv[i]);
-        if (arg == "-no_parallel")
-            parallel = false;
-        else if (arg == "-no_xml_formatting")
-            formatting = false;
-        else if (arg == "-silent")
-            silent = true;
-        else if (arg == "-alias")
-            mode = WRITER_MODE_ALIAS;
-        else if (arg == "-graph")
-            mode = WRITER_MODE_GRAPH;
-        else{
-            std::cerr << "Unrecognised argument!" <<std::endl;
-            printUsage();
-            exit(0);
-        }
+    QStringList arguments;
+    for (int i=3; i<argc; i++)
+        arguments.append(QString(argv[i]));
+    QString error;
+    if (!parseOptions(arguments, options, error)){
+        std::cerr << error.toLocal8Bit().data() <<std::endl;
+        printUsage();
+        exit(0);
+    }
+    error = incompatibleOptions(options);
+    if (!error.isEmpty()){
+        std::cerr << error.toLocal8Bit().data() <<std::endl;
+        exit(0);
     }
 
-    splitter = new SpineMLSplitter(parallel, formatting, silent, mode);
+    splitter = createSplitter(options);
 
-    splitter->split(input_file, output_file);
+    if (input_file == "-batch")
+        splitter->splitBatch(output_file);
+    else
+        splitter->split(input_file, output_file);
 
     std::cout << "Completed Time: " << formatMillis(splitter->getTotalTime()).toLocal8Bit().data() << std::endl;
+    if (options.planned){
+        delete splitter;
+        return 0;
+    }
     std::cout << "Splitting Time: " << formatMillis(splitter->getSplitTime()).toLocal8Bit().data() << std::endl;
 
     std::cout << (splitter->getParser()->getParsedPopulationCount()) << " Parsed Populations" << std::endl;
@@ -0,0 +1,187 @@
+#include "mappedinputfile.h"
+
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#endif
+
+
+MappedDevice::MappedDevice()
+{
+    mapped_data = NULL;
+    mapped_size = 0;
+    ascii = true;
+}
+
+void MappedDevice::setData(const char *data, qint64 data_size)
+{
+    mapped_data = data;
+    mapped_size = data_size;
+}
+
+bool MappedDevice::open(OpenMode mode)
+{
+    //the data is already in memory so is read without the device buffer
+    if (mode & QIODevice::WriteOnly)
+        return false;
+    ascii = true;
+    return QIODevice::open(mode | QIODevice::Unbuffered);
+}
+
+qint64 MappedDevice::size() const
+{
+    return mapped_size;
+}
+
+qint64 MappedDevice::readData(char *data, qint64 max_size)
+{
+    qint64 read_size = qMin(max_size, mapped_size - pos());
+    if (read_size <= 0)
+        return 0;
+    memcpy(data, mapped_data + pos(), read_size);
+
+    //the block is checked while in cache (until the first non ascii byte) so the reader need not scan the document again
+    for (qint64 i=0; ascii && (i<read_size); i++){
+        if (data[i] & 0x80)
+            ascii = false;
+    }
+    return read_size;
+}
+
+bool MappedDevice::isAscii()
+{
+    return ascii;
+}
+
+qint64 MappedDevice::writeData(const char *, qint64)
+{
+    //read only
+    return -1;
+}
+
+
+MappedInputFile::MappedInputFile(QString filename, bool use_mmap)
+    : file(filename)
+{
+    this->use_mmap = use_mmap;
+    mapping = NULL;
+    mapping_size = 0;
+    in_memory = false;
+}
+
+MappedInputFile::MappedInputFile(const QByteArray &document)
+{
+    use_mmap = false;
+    mapping = NULL;
+    mapping_size = 0;
+    this->document = document;  //implicitly shared (not copied)
+    in_memory = true;
+}
+
+MappedInputFile::~MappedInputFile()
+{
+    close();
+}
+
+bool MappedInputFile::open()
+{
+    if (in_memory){
+        mapped_device.setData(document.constData(), document.size());
+        return mapped_device.open(QIODevice::ReadOnly);
+    }
+
+    //no mmap: buffered file io with text mode as before
+    if (!use_mmap)
+        return file.open(QIODevice::ReadOnly | QIODevice::Text);
+
+    //no text mode translation required as the xml reader handles line endings itself
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    mapping_size = file.size();
+    if (mapping_size > 0)
+        mapping = file.map(0, mapping_size);
+
+    //fall back to reading from the file if the mapping fails (e.g. empty file or special file)
+    if (mapping == NULL)
+        return true;
+
+#ifdef Q_OS_UNIX
+    //both passes over the file read from start to end
+    madvise(mapping, mapping_size, MADV_SEQUENTIAL);
+#endif
+
+    //zero copy view of the mapped file
+    mapped_device.setData((const char*)mapping, mapping_size);
+    return mapped_device.open(QIODevice::ReadOnly);
+}
+
+void MappedInputFile::reset()
+{
+    device()->reset();
+}
+
+void MappedInputFile::close()
+{
+    if (in_memory){
+        mapped_device.close();
+        return;
+    }
+    if (mapping){
+        mapped_device.close();
+        mapped_device.setData(NULL, 0);
+        file.unmap(mapping);
+        mapping = NULL;
+        mapping_size = 0;
+    }
+    if (file.isOpen())
+        file.close();
+}
+
+QIODevice *MappedInputFile::device()
+{
+    if (mapping || in_memory)
+        return &mapped_device;
+    return &file;
+}
+
+QString MappedInputFile::fileName()
+{
+    if (in_memory)
+        return QString();
+    return file.fileName();
+}
+
+const char *MappedInputFile::data()
+{
+    if (mapping)
+        return (const char*)mapping;
+    if (in_memory)
+        return document.constData();
+    return NULL;
+}
+
+qint64 MappedInputFile::dataSize()
+{
+    if (mapping)
+        return mapping_size;
+    if (in_memory)
+        return document.size();
+    return 0;
+}
+
+bool MappedInputFile::isMapped()
+{
+    return (mapping != NULL);
+}
+
+bool MappedInputFile::isResident()
+{
+    return (mapping != NULL) || in_memory;
+}
+
+bool MappedInputFile::isAsciiRead()
+{
+    return isResident() && mapped_device.isAscii();
+}
@@ -0,0 +1,62 @@
+#ifndef MAPPEDINPUTFILE_H
+#define MAPPEDINPUTFILE_H
+
+#include <QFile>
+#include <QIODevice>
+#include <QByteArray>
+
+//read only device over raw memory (a file mapping or an in memory document) which is not copied
+//QBuffer over QByteArray::fromRawData is limited to int sizes so would not map files of 2GB or more
+class MappedDevice : public QIODevice
+{
+public:
+    MappedDevice();
+
+    void setData(const char *data, qint64 data_size);
+    bool open(OpenMode mode);
+    qint64 size() const;
+    bool isAscii();     //every byte read since the device was opened is ascii
+
+protected:
+    qint64 readData(char *data, qint64 max_size);
+    qint64 writeData(const char *data, qint64 max_size);
+
+private:
+    const char *mapped_data;
+    qint64 mapped_size;
+    bool ascii;
+};
+
+//input file which (optionally) memory maps the file and provides a read only device over the mapping
+//the mapping is shared by all passes over the file (reset seeks back to the start of the mapping)
+//a document already in memory is read through the same device without a file
+class MappedInputFile
+{
+public:
+    MappedInputFile(QString filename, bool use_mmap = true);
+    MappedInputFile(const QByteArray &document);
+    ~MappedInputFile();
+
+    bool open();
+    void reset();
+    void close();
+
+    QIODevice *device();
+    const char *data();     //the mapping or in memory document, NULL if not resident
+    qint64 dataSize();
+    QString fileName();     //empty for an in memory document
+    bool isMapped();
+    bool isResident();      //data() is the mapping or in memory document (the file is otherwise only read through the device)
+    bool isAsciiRead();     //every byte read through the device of a resident document is ascii
+
+private:
+    QFile file;
+    bool use_mmap;
+    uchar *mapping;
+    qint64 mapping_size;
+    QByteArray document;        //in memory document (implicitly shared)
+    bool in_memory;
+    MappedDevice mapped_device; //device over the mapping (or the in memory document)
+};
+
+#endif // MAPPEDINPUTFILE_H
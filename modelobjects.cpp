@@ -2,12 +2,113 @@
 #include <QDebug>
 #include <iostream>
 #include <QStringList>
+#include <algorithm>
+
+//index under a permutation (the identity when the permutation is empty or does not cover the index)
+static inline uint permutedIndex(const QVector<uint> &permutation, uint index)
+{
+    return (index < (uint)permutation.size()) ? permutation[index] : index;
+}
+
+
+/* PopulationPartition */
+
+void PopulationPartition::setUniform(uint size, uint max_size)
+{
+    this->max_size = max_size;
+    uniform = true;
+    node_offsets.clear();
+    uint count = (size + max_size - 1) / max_size;
+    offsets.resize(count+1);
+    for (uint i=0; i<count; i++)
+        offsets[i] = i*max_size;
+    offsets[count] = size;
+}
+
+void PopulationPartition::setOffsets(const QVector<uint> &offsets, uint max_size)
+{
+    this->offsets = offsets;
+    this->max_size = max_size;
+    uniform = true;
+    for (int i=1; i<offsets.size()-1; i++){
+        if ((offsets[i] - offsets[i-1]) != max_size)
+            uniform = false;
+    }
+    node_offsets.clear();
+}
+
+void PopulationPartition::setHierarchical(uint size, uint node_count, uint max_size)
+{
+    //node k holds the same fraction of every population (node partitions of small populations may be empty)
+    uint node_size = (size + node_count - 1) / node_count;
+    QVector<uint> core_offsets;
+    node_offsets.clear();
+    for (uint k=0; k<node_count; k++){
+        node_offsets.append(core_offsets.size());
+        uint node_end = qMin(size, (k+1)*node_size);
+        for (uint n=k*node_size; n<node_end; n+=max_size)
+            core_offsets.append(n);
+    }
+    node_offsets.append(core_offsets.size());
+    core_offsets.append(size);
+
+    QVector<uint> hierarchical_node_offsets = node_offsets;
+    setOffsets(core_offsets, max_size);
+    node_offsets = hierarchical_node_offsets;
+}
+
+uint PopulationPartition::count() const
+{
+    return offsets.size()-1;
+}
+
+uint PopulationPartition::start(uint sub_index) const
+{
+    return offsets[sub_index];
+}
+
+uint PopulationPartition::size(uint sub_index) const
+{
+    return offsets[sub_index+1] - offsets[sub_index];
+}
+
+uint PopulationPartition::index(uint neuron) const
+{
+    if (uniform)
+        return index<true>(neuron);
+    return index<false>(neuron);
+}
+
+bool PopulationPartition::isHierarchical() const
+{
+    return !node_offsets.isEmpty();
+}
+
+uint PopulationPartition::nodeCount() const
+{
+    if (node_offsets.isEmpty())
+        return 1;
+    return node_offsets.size()-1;
+}
+
+uint PopulationPartition::node(uint sub_index) const
+{
+    //empty node partitions share the offset of the next node so the last node starting at or before the index is taken
+    if (node_offsets.isEmpty())
+        return 0;
+    return (std::upper_bound(node_offsets.constBegin(), node_offsets.constEnd(), sub_index) - node_offsets.constBegin()) - 1;
+}
+
+uint PopulationPartition::core(uint sub_index) const
+{
+    if (node_offsets.isEmpty())
+        return sub_index;
+    return sub_index - node_offsets[node(sub_index)];
+}
 
 Component::~Component(){
-    for (int i=0;i<properties.size();i++)
-        delete properties[i];
-    for (int i=0;i<inputs.values().size();i++)
-        delete inputs.values()[i];
+    qDeleteAll(properties);
+    qDeleteAll(inputs);
 }
 
 Population::Population()
@@ -16,39 +117,566 @@ Population::Population()
 }
 
 Population::~Population(){
-    for (int i=0;i<projections.values().size();i++)
-        delete projections.values()[i];
+    qDeleteAll(projections);
     if (neuron != NULL)
         delete neuron;
 }
 
-PropertyValueList::~PropertyValueList(){
-    for (int i=0;i<valueInstances.size();i++)
-        delete valueInstances[i];
+PropertyValueList::PropertyValueList()
+{
+    dense = false;
+    value_count = 0;
+}
+
+void PropertyValueList::appendValue(uint index, double value)
+{
+    sparse_indices.append(index);
+    sparse_values.append(value);
+}
+
+template <bool DENSE> uint PropertyValueList::appendRangeKernel(PropertyValueList *list, uint start, uint count, uint dst_start, uint p)
+{
+    //returns the sparse position after the range (searches of later ranges start there)
+    uint end = start + count;
+    if (DENSE){
+        uint range_end = qMin(end, (uint)list->dense_values.size());
+        const quint64 *present = list->dense_present.constData();
+        const double *values = list->dense_values.constData();
+        for (uint i=start; i<range_end; i++){
+            if (present[i/64] & (Q_UINT64_C(1) << (i%64)))
+                appendValue(dst_start + (i-start), values[i]);
+        }
+        return 0;
+    }
+    const uint *indices = list->sparse_indices.constData();
+    uint n = list->sparse_indices.size();
+    p = std::lower_bound(indices + qMin(p, n), indices + n, start) - indices;
+    for (; (p < n) && (indices[p] < end); p++)
+        appendValue(dst_start + (indices[p]-start), list->sparse_values[p]);
+    return p;
+}
+
+template <bool DENSE> void PropertyValueList::appendGatherKernel(PropertyValueList *list, const QVector<uint> &src_indices, const QVector<uint> &dst_indices)
+{
+    uint n = src_indices.size();
+    sparse_indices.reserve(sparse_indices.size() + n);
+    sparse_values.reserve(sparse_values.size() + n);
+    if (DENSE){
+        uint size = list->dense_values.size();
+        const quint64 *present = list->dense_present.constData();
+        const double *values = list->dense_values.constData();
+        for (uint k=0; k<n; k++){
+            uint index = src_indices[k];
+            if ((index < size) && (present[index/64] & (Q_UINT64_C(1) << (index%64))))
+                appendValue(dst_indices[k], values[index]);
+        }
+        return;
+    }
+    //single search per value (rather than a search for contains and another for value)
+    const uint *first = list->sparse_indices.constBegin();
+    const uint *last = list->sparse_indices.constEnd();
+    for (uint k=0; k<n; k++){
+        const uint *i = std::lower_bound(first, last, src_indices[k]);
+        if ((i != last) && (*i == src_indices[k]))
+            appendValue(dst_indices[k], list->sparse_values[i - first]);
+    }
+}
+
+void PropertyValueList::appendRange(PropertyValueList *list, uint start, uint count, uint dst_start)
+{
+    if (list->dense)
+        appendRangeKernel<true>(list, start, count, dst_start, 0);
+    else
+        appendRangeKernel<false>(list, start, count, dst_start, 0);
+}
+
+void PropertyValueList::appendRows(PropertyValueList *list, uint start, uint row_count, uint row_stride, uint col_count)
+{
+    if (list->dense){
+        for (uint row=0; row<row_count; row++)
+            appendRangeKernel<true>(list, start + row*row_stride, col_count, row*col_count, 0);
+        return;
+    }
+    //rows are ascending so the search of each row continues from the end of the previous row
+    uint p = 0;
+    for (uint row=0; row<row_count; row++)
+        p = appendRangeKernel<false>(list, start + row*row_stride, col_count, row*col_count, p);
+}
+
+void PropertyValueList::appendGather(PropertyValueList *list, const QVector<uint> &src_indices, const QVector<uint> &dst_indices)
+{
+    if (list->dense)
+        appendGatherKernel<true>(list, src_indices, dst_indices);
+    else
+        appendGatherKernel<false>(list, src_indices, dst_indices);
+}
+
+uint PropertyValueList::finalise()
+{
+    uint n = sparse_indices.size();
+
+    //sort appended values by index (stable so the first of any duplicates is kept)
+    bool ordered = true;
+    for (uint i=1; i<n && ordered; i++){
+        if (sparse_indices[i] <= sparse_indices[i-1])
+            ordered = false;
+    }
+    uint duplicates = 0;
+    if (!ordered){
+        QVector<QPair<uint, uint> > order(n);
+        for (uint i=0; i<n; i++)
+            order[i] = qMakePair(sparse_indices[i], i);
+        std::stable_sort(order.begin(), order.end());
+        QVector<uint> sorted_indices;
+        QVector<double> sorted_values;
+        sorted_indices.reserve(n);
+        sorted_values.reserve(n);
+        for (uint i=0; i<n; i++){
+            if ((i>0) && (order[i].first == order[i-1].first)){
+                duplicates++;
+                continue;
+            }
+            sorted_indices.append(order[i].first);
+            sorted_values.append(sparse_values[order[i].second]);
+        }
+        sparse_indices.swap(sorted_indices);
+        sparse_values.swap(sorted_values);
+    }
+    value_count = sparse_indices.size();
+
+    //dense if occupancy of the index range is high enough
+    uint range = value_count ? sparse_indices.last()+1 : 0;
+    dense = (value_count > 0) && ((qint64)value_count * VALUE_LIST_SPARSE_OCCUPANCY >= range);
+    if (dense){
+        dense_values.fill(0, range);
+        dense_present.fill(0, (range+63)/64);
+        for (uint i=0; i<value_count; i++){
+            uint index = sparse_indices[i];
+            dense_values[index] = sparse_values[i];
+            dense_present[index/64] |= (Q_UINT64_C(1) << (index%64));
+        }
+        sparse_indices.clear();
+        sparse_values.clear();
+    }
+    sparse_indices.squeeze();
+    sparse_values.squeeze();
+    return duplicates;
+}
+
+void PropertyValueList::truncate(uint size)
+{
+    if (dense){
+        if ((uint)dense_values.size() <= size)
+            return;
+        for (uint i=size; i<(uint)dense_values.size(); i++){
+            if (dense_present[i/64] & (Q_UINT64_C(1) << (i%64)))
+                value_count--;
+        }
+        dense_values.resize(size);
+        dense_present.resize((size+63)/64);
+        if (size%64)
+            dense_present.last() &= (Q_UINT64_C(1) << (size%64)) - 1;
+    }else{
+        int p = std::lower_bound(sparse_indices.constBegin(), sparse_indices.constEnd(), size) - sparse_indices.constBegin();
+        sparse_indices.resize(p);
+        sparse_values.resize(p);
+        value_count = p;
+    }
+}
+
+void PropertyValueList::permute(const QVector<uint> &row_permutation, const QVector<uint> &col_permutation, uint col_count)
+{
+    if (row_permutation.isEmpty() && col_permutation.isEmpty())
+        return;
+    PropertyValueList permuted;
+    for (int i=firstIndex(); i>=0; i=nextIndex(i)){
+        uint row = i / col_count;
+        uint col = i % col_count;
+        permuted.appendValue(permutedIndex(row_permutation, row)*col_count + permutedIndex(col_permutation, col), value(i));
+    }
+    permuted.finalise();
+
+    dense = permuted.dense;
+    value_count = permuted.value_count;
+    dense_values.swap(permuted.dense_values);
+    dense_present.swap(permuted.dense_present);
+    sparse_indices.swap(permuted.sparse_indices);
+    sparse_values.swap(permuted.sparse_values);
+}
+
+uint PropertyValueList::count()
+{
+    return value_count;
+}
+
+bool PropertyValueList::contains(uint index)
+{
+    if (dense)
+        return (index < (uint)dense_values.size()) && (dense_present[index/64] & (Q_UINT64_C(1) << (index%64)));
+    return std::binary_search(sparse_indices.constBegin(), sparse_indices.constEnd(), index);
+}
+
+double PropertyValueList::value(uint index)
+{
+    if (dense)
+        return (index < (uint)dense_values.size()) ? dense_values[index] : 0;
+    const uint *i = std::lower_bound(sparse_indices.constBegin(), sparse_indices.constEnd(), index);
+    if ((i == sparse_indices.constEnd()) || (*i != index))
+        return 0;
+    return sparse_values[i - sparse_indices.constBegin()];
+}
+
+int PropertyValueList::firstIndex()
+{
+    return nextIndex(-1);
+}
+
+int PropertyValueList::nextIndex(int index)
+{
+    uint i = index+1;
+    if (dense){
+        //skip empty bitmap words
+        uint size = dense_values.size();
+        while (i < size){
+            quint64 word = dense_present[i/64] >> (i%64);
+            if (word)
+                return i + __builtin_ctzll(word);
+            i = (i/64 + 1)*64;
+        }
+        return -1;
+    }
+    const uint *next = std::lower_bound(sparse_indices.constBegin(), sparse_indices.constEnd(), i);
+    if (next == sparse_indices.constEnd())
+        return -1;
+    return *next;
+}
+
+bool PropertyValueList::isDense()
+{
+    return dense;
 }
 
 Projection::~Projection(){
-    for (int i=0;i<synapses.values().size();i++)
-        delete synapses.values()[i];
+    qDeleteAll(synapses);
+}
+
+ConnectionList::ConnectionList(bool rows_are_src)
+{
+    this->rows_are_src = rows_are_src;
+    materialised = false;
+}
+
+void ConnectionList::appendConnection(uint row, uint col, double delay, uint index)
+{
+    pending_rows.append(row);
+    cols.append(col);
+    delays.append(delay);
+    indices.append(index);
+}
+
+void ConnectionList::reserve(uint count)
+{
+    pending_rows.reserve(count);
+    cols.reserve(count);
+    delays.reserve(count);
+    indices.reserve(count);
+}
+
+//orders positions within a row by column
+class ColumnLessThan
+{
+public:
+    ColumnLessThan(const QVector<uint> &cols) : cols(cols){}
+    bool operator()(uint a, uint b) const {return cols[a] < cols[b];}
+private:
+    const QVector<uint> &cols;
+};
+
+bool ConnectionList::compress(bool reindex)
+{
+    uint n = cols.size();
+
+    //row count and check for connections already appended in (row, col) order
+    uint row_count = 0;
+    bool ordered = true;
+    for (uint i=0; i<n; i++){
+        if (pending_rows[i] >= row_count)
+            row_count = pending_rows[i]+1;
+        if ((i>0) && ((pending_rows[i] < pending_rows[i-1]) || ((pending_rows[i] == pending_rows[i-1]) && (cols[i] <= cols[i-1]))))
+            ordered = false;
+    }
+
+    //row offsets
+    row_offsets.fill(0, row_count+1);
+    for (uint i=0; i<n; i++)
+        row_offsets[pending_rows[i]+1]++;
+    for (uint r=0; r<row_count; r++)
+        row_offsets[r+1] += row_offsets[r];
+
+    if (!ordered){
+        //counting sort by row (stable)
+        QVector<uint> next = row_offsets;
+        QVector<uint> order(n);
+        for (uint i=0; i<n; i++)
+            order[next[pending_rows[i]]++] = i;
+
+        //sort each row by column
+        ColumnLessThan less_than(cols);
+        for (uint r=0; r<row_count; r++)
+            std::sort(order.begin()+row_offsets[r], order.begin()+row_offsets[r+1], less_than);
+
+        QVector<uint> sorted_cols(n);
+        QVector<double> sorted_delays(n);
+        QVector<uint> sorted_indices(n);
+        for (uint p=0; p<n; p++){
+            sorted_cols[p] = cols[order[p]];
+            sorted_delays[p] = delays[order[p]];
+            sorted_indices[p] = indices[order[p]];
+        }
+        cols.swap(sorted_cols);
+        delays.swap(sorted_delays);
+        indices.swap(sorted_indices);
+        if ((uint)parent_indices.size() == n){
+            QVector<uint> sorted_parent_indices(n);
+            for (uint p=0; p<n; p++)
+                sorted_parent_indices[p] = parent_indices[order[p]];
+            parent_indices.swap(sorted_parent_indices);
+        }
+    }
+    pending_rows.clear();
+    pending_rows.squeeze();
+    cols.squeeze();
+    delays.squeeze();
+    indices.squeeze();
+
+    if (reindex){
+        for (uint p=0; p<n; p++)
+            indices[p] = p;
+    }
+
+    //duplicates are adjacent once sorted
+    for (uint r=0; r<row_count; r++){
+        for (uint p=row_offsets[r]+1; p<row_offsets[r+1]; p++){
+            if (cols[p] == cols[p-1])
+                return false;
+        }
+    }
+    return true;
+}
+
+void ConnectionList::buildTransposed()
+{
+    uint n = cols.size();
+    uint col_count = 0;
+    for (uint p=0; p<n; p++){
+        if (cols[p] >= col_count)
+            col_count = cols[p]+1;
+    }
+
+    t_offsets.fill(0, col_count+1);
+    for (uint p=0; p<n; p++)
+        t_offsets[cols[p]+1]++;
+    for (uint c=0; c<col_count; c++)
+        t_offsets[c+1] += t_offsets[c];
+
+    //rows are visited in order so each column is ordered by row
+    QVector<uint> next = t_offsets;
+    t_rows.resize(n);
+    t_positions.resize(n);
+    for (uint r=0; r<rowCount(); r++){
+        for (uint p=row_offsets[r]; p<row_offsets[r+1]; p++){
+            uint t = next[cols[p]]++;
+            t_rows[t] = r;
+            t_positions[t] = p;
+        }
+    }
+}
+
+void ConnectionList::buildBuckets(const PopulationPartition &row_partition, const PopulationPartition &col_partition)
+{
+    uint n = cols.size();
+    uint row_count = rowCount();
+    uint row_blocks = row_partition.count();
+    uint col_blocks = col_partition.count();
+    for (uint p=0; p<n; p++){
+        if (col_partition.index(cols[p]) >= col_blocks)
+            col_blocks = col_partition.index(cols[p]) + 1;
+    }
+
+    block_buckets.fill(0, row_blocks+1);
+    bucket_rows.resize(n);
+    bucket_positions.resize(n);
+
+    //count the (non empty) buckets of each row block
+    #pragma omp parallel
+    {
+        QVector<uint> counts(col_blocks, 0);
+        #pragma omp for schedule(dynamic)
+        for (int b=0; b<(int)row_blocks; b++){
+            uint start = row_offsets[qMin(row_partition.start(b), row_count)];
+            uint end = row_offsets[qMin(row_partition.start(b+1), row_count)];
+            uint buckets = 0;
+            for (uint p=start; p<end; p++){
+                if (counts[col_partition.index(cols[p])]++ == 0)
+                    buckets++;
+            }
+            block_buckets[b+1] = buckets;
+            for (uint p=start; p<end; p++)
+                counts[col_partition.index(cols[p])] = 0;
+        }
+    }
+    for (uint b=0; b<row_blocks; b++)
+        block_buckets[b+1] += block_buckets[b];
+    bucket_cols.resize(block_buckets[row_blocks]);
+    bucket_offsets.resize(block_buckets[row_blocks]+1);
+    bucket_offsets[block_buckets[row_blocks]] = n;
+
+    //counting sort each row block by col block (stable so buckets are ordered by row then col)
+    #pragma omp parallel
+    {
+        QVector<uint> next(col_blocks, 0);
+        QVector<uint> block_cols;
+        #pragma omp for schedule(dynamic)
+        for (int b=0; b<(int)row_blocks; b++){
+            uint first_row = qMin(row_partition.start(b), row_count);
+            uint last_row = qMin(row_partition.start(b+1), row_count);
+            uint start = row_offsets[first_row];
+            uint end = row_offsets[last_row];
+            block_cols.clear();
+            for (uint p=start; p<end; p++){
+                uint col_block = col_partition.index(cols[p]);
+                if (next[col_block]++ == 0)
+                    block_cols.append(col_block);
+            }
+            std::sort(block_cols.begin(), block_cols.end());
+            uint offset = start;
+            for (int k=0; k<block_cols.size(); k++){
+                uint bucket = block_buckets[b]+k;
+                uint count = next[block_cols[k]];
+                bucket_cols[bucket] = block_cols[k];
+                bucket_offsets[bucket] = offset;
+                next[block_cols[k]] = offset;
+                offset += count;
+            }
+            for (uint r=first_row; r<last_row; r++){
+                for (uint p=row_offsets[r]; p<row_offsets[r+1]; p++){
+                    uint k = next[col_partition.index(cols[p])]++;
+                    bucket_rows[k] = r;
+                    bucket_positions[k] = p;
+                }
+            }
+            for (int k=0; k<block_cols.size(); k++)
+                next[block_cols[k]] = 0;
+        }
+    }
 }
 
-ConnectionList::~ConnectionList(){
-    /*for (int i=0;i<connectionInstances.size();i++)
-        delete connectionInstances[i];
-        */
-    for (int i=0;i<connectionMatrix.keys().size();i++){
-        uint x = connectionMatrix.keys()[i];
-        for (int j=0;j<connectionMatrix[x].keys().size();j++){
-            uint y = connectionMatrix[x].keys()[j];
-            delete connectionMatrix[x][y];
+void ConnectionList::permute(const QVector<uint> &row_permutation, const QVector<uint> &col_permutation)
+{
+    if (row_permutation.isEmpty() && col_permutation.isEmpty())
+        return;
+    //renumber then compress again (connection indices are kept so index based properties are unchanged)
+    uint row_count = rowCount();
+    pending_rows.resize(cols.size());
+    for (uint r=0; r<row_count; r++){
+        for (uint p=row_offsets[r]; p<row_offsets[r+1]; p++){
+            pending_rows[p] = permutedIndex(row_permutation, r);
+            cols[p] = permutedIndex(col_permutation, cols[p]);
         }
     }
+    compress(false);
+
+    //views are of the old numbering
+    t_offsets.clear();
+    t_rows.clear();
+    t_positions.clear();
+    block_buckets.clear();
+    bucket_cols.clear();
+    bucket_offsets.clear();
+    bucket_rows.clear();
+    bucket_positions.clear();
+}
+
+uint ConnectionList::bucketStart(uint row_block)
+{
+    if (row_block+1 >= (uint)block_buckets.size())
+        return bucket_cols.size();
+    return block_buckets[row_block];
+}
+
+uint ConnectionList::bucketEnd(uint row_block)
+{
+    if (row_block+1 >= (uint)block_buckets.size())
+        return bucket_cols.size();
+    return block_buckets[row_block+1];
+}
+
+uint ConnectionList::size()
+{
+    return cols.size();
+}
+
+uint ConnectionList::rowCount()
+{
+    if (row_offsets.isEmpty())
+        return 0;
+    return row_offsets.size()-1;
+}
+
+uint ConnectionList::rowStart(uint row)
+{
+    if (row >= rowCount())
+        return cols.size();
+    return row_offsets[row];
+}
+
+uint ConnectionList::rowEnd(uint row)
+{
+    if (row >= rowCount())
+        return cols.size();
+    return row_offsets[row+1];
+}
+
+int ConnectionList::find(uint row, uint col)
+{
+    const uint *begin = cols.constData() + rowStart(row);
+    const uint *end = cols.constData() + rowEnd(row);
+    const uint *c = std::lower_bound(begin, end, col);
+    if ((c != end) && (*c == col))
+        return c - cols.constData();
+    return -1;
+}
+
+uint ConnectionList::srcNeuron(uint row, uint pos)
+{
+    return rows_are_src ? row : cols[pos];
+}
+
+uint ConnectionList::dstNeuron(uint row, uint pos)
+{
+    return rows_are_src ? cols[pos] : row;
+}
+
+uint ConnectionList::colStart(uint col)
+{
+    if (col+1 >= (uint)t_offsets.size())
+        return t_rows.size();
+    return t_offsets[col];
+}
+
+uint ConnectionList::colEnd(uint col)
+{
+    if (col+1 >= (uint)t_offsets.size())
+        return t_rows.size();
+    return t_offsets[col+1];
 }
 
 Input::Input()
 {
     remapping = NULL;
     sub_inp_max = 0;
+    sub_inp_node_max = 0;
+    sub_inp_remote_max = 0;
 }
 
 Input::~Input()
@@ -63,6 +691,8 @@ Synapse::Synapse()
     weightupdate = NULL;
     postsynapse = NULL;
     _sub_syn_max = 0;
+    _sub_syn_node_max = 0;
+    _sub_syn_remote_max = 0;
 }
 
 Synapse::~Synapse()
@@ -6,6 +6,9 @@
 #include <QHash>
 #include <QMap>
 #include <QSet>
+#include <algorithm>
+
+#include "arena.h"
 
 
 /* forward declarations */
@@ -24,6 +27,10 @@ class Postsynapse;
 class AbstractionConnection;
 
 
+//value lists with fewer than 1/VALUE_LIST_SPARSE_OCCUPANCY of their index range set are stored sparsely
+#define VALUE_LIST_SPARSE_OCCUPANCY 4
+
+
 /* typedefs */
 
 typedef enum
@@ -57,6 +64,37 @@ typedef enum
 
 
 
+/* Partition of a population into contiguous sub populations */
+
+class PopulationPartition
+{
+public:
+    PopulationPartition(){ max_size = 0; uniform = true;}
+    void setUniform(uint size, uint max_size);
+    void setOffsets(const QVector<uint> &offsets, uint max_size);
+    void setHierarchical(uint size, uint node_count, uint max_size);   //equal node partitions each split into sub populations of at most max_size
+    uint count() const;
+    uint start(uint sub_index) const;
+    uint size(uint sub_index) const;
+    uint index(uint neuron) const;      //sub population of a neuron
+    template <bool UNIFORM> uint index(uint neuron) const   //specialised on uniform() for loops over many neurons
+    {
+        if (UNIFORM)
+            return neuron / max_size;
+        return (std::upper_bound(offsets.constBegin(), offsets.constEnd(), neuron) - offsets.constBegin()) - 1;
+    }
+    bool isHierarchical() const;
+    uint nodeCount() const;
+    uint node(uint sub_index) const;    //node partition of a sub population (0 if not hierarchical)
+    uint core(uint sub_index) const;    //index of a sub population within its node partition
+public:
+    QVector<uint> offsets;  //count()+1 neuron offsets of the sub populations
+    uint max_size;          //maximum sub population size
+    bool uniform;           //every sub population other than the last is max_size
+    QVector<uint> node_offsets; //nodeCount()+1 sub population offsets of the node partitions (empty if not hierarchical)
+};
+
+
 /* Component Info Classes - for information parsing stage */
 
 class ComponentInfo
@@ -82,7 +120,7 @@ public:
 public:
     uint global_index;
     uint global_sub_start_index;
-    uint splits;
+    PopulationPartition partition;
 };
 
 class WeightUpdateInfo: public ComponentInfo
@@ -93,6 +131,7 @@ public:
     ComponentType Type(){return COMPONENT_TYPE_WEIGHT_UPDATE;}
     void calculateDimensions(QHash<QString, ComponentInfo *> &component_info);
 public:
+    QString population;     //population the projection is defined in
     QString projPopulation;
     uint srcPopSize;
     uint dstPopSize;
@@ -112,10 +151,20 @@ public:
 
 };
 
+//input recorded by the info parse (inputs are not components so are only used for planning)
+class InputInfo
+{
+public:
+    QString src;
+    QString dst_population;     //population of the component receiving the input
+    ConnectivityType connectivity;
+    uint connectionListCount;   //only used when connectivity == LIST
+};
+
 
 /* Component Classes - for full parsing stage */
 
-class Component
+class Component: public ArenaAllocated
 {
 public:
     Component(){}
@@ -129,7 +178,7 @@ public:
 };
 
 
-class Population
+class Population: public ArenaAllocated
 {
 public:
     Population();
@@ -151,7 +200,7 @@ public:
     uint size;
 };
 
-class Property
+class Property: public ArenaAllocated
 {
 public:
     Property();
@@ -162,7 +211,7 @@ public:
     QString dimension;
 };
 
-class PropertyValue
+class PropertyValue: public ArenaAllocated
 {
 public:
     virtual ~PropertyValue(){}
@@ -179,23 +228,45 @@ public:
     double value;
 };
 
-class PropertyValueInstance
-{
-public:
-    PropertyValueInstance(){}
-public:
-    uint index;
-    double value;
-};
-
+//value list stored densely (values plus presence bitmap) or, if occupancy is low, sparsely (sorted indices and values)
+//values are appended in any order then finalised before use. Iterate in index order with
+//for (int i=list->firstIndex(); i>=0; i=list->nextIndex(i))
 class PropertyValueList: public PropertyValue
 {
 public:
-    PropertyValueList(){}
-    ~PropertyValueList();
+    PropertyValueList();
+    ~PropertyValueList(){}
     PropertyValueType Type(){return VALUE_LIST_TYPE;}
-public:
-    QHash <int, PropertyValueInstance*> valueInstances; // <index, value instance>
+
+    //building
+    void appendValue(uint index, double value);
+    void appendRange(PropertyValueList *list, uint start, uint count, uint dst_start);  //appends values in [start, start+count) of a finalised list
+    void appendRows(PropertyValueList *list, uint start, uint row_count, uint row_stride, uint col_count); //appends ranges [start + row*row_stride, +col_count) of a finalised list as contiguous rows of col_count
+    void appendGather(PropertyValueList *list, const QVector<uint> &src_indices, const QVector<uint> &dst_indices); //appends the value at each src index of a finalised list at the matching dst index
+    uint finalise();                    //returns the number of duplicate indices ignored (first value is kept)
+    void truncate(uint size);           //removes indices >= size
+    void permute(const QVector<uint> &row_permutation, const QVector<uint> &col_permutation, uint col_count); //index (row*col_count + col) moves to (row_permutation[row]*col_count + col_permutation[col]), empty permutations are the identity
+
+    //access (once finalised)
+    uint count();
+    bool contains(uint index);
+    double value(uint index);
+    int firstIndex();
+    int nextIndex(int index);
+    bool isDense();
+
+private:
+    //kernels specialised on the storage of the source list (selected once per call rather than per value)
+    template <bool DENSE> uint appendRangeKernel(PropertyValueList *list, uint start, uint count, uint dst_start, uint p);
+    template <bool DENSE> void appendGatherKernel(PropertyValueList *list, const QVector<uint> &src_indices, const QVector<uint> &dst_indices);
+
+private:
+    bool dense;
+    uint value_count;
+    QVector<double> dense_values;
+    QVector<quint64> dense_present;     //presence bitmap
+    QVector<uint> sparse_indices;       //sorted (appended values before finalise)
+    QVector<double> sparse_values;
 };
 
 
@@ -231,7 +302,7 @@ public:
     double mean;
 };
 
-class Input
+class Input: public ArenaAllocated
 {
 public:
     Input();
@@ -244,11 +315,13 @@ public:
 public:
     Input * unsplit_input;
     uint sub_inp_max;            //stores (in unsplit input) the max number of sub inputs for the in any of split populations
+    uint sub_inp_node_max;       //stores (in unsplit input) the max number of sub inputs from the same node partition (hierarchical splits only)
+    uint sub_inp_remote_max;     //stores (in unsplit input) the max number of sub inputs from other node partitions (hierarchical splits only)
     uint sub_inp_index;          //stores (in sub synapse) the sub synapse index
     uint unsplit_index;          //stores (for unsplit inputs) the index of the inputs (with respect to the parent component)
 };
 
-class Projection
+class Projection: public ArenaAllocated
 {
 public:
     Projection(){}
@@ -259,7 +332,7 @@ public:
     uint index;                         //unsplit index of projection in population
 };
 
-class Synapse
+class Synapse: public ArenaAllocated
 {
 public:
     Synapse();
@@ -271,6 +344,8 @@ public:
 public:
     Synapse * unsplit_synapse;
     uint _sub_syn_max;            //stores (in unsplit synapse) the max number of sub synapses for any split populations
+    uint _sub_syn_node_max;       //stores (in unsplit synapse) the max number of sub synapses within the same node partition (hierarchical splits only)
+    uint _sub_syn_remote_max;     //stores (in unsplit synapse) the max number of sub synapses to other node partitions (hierarchical splits only)
     uint _sub_syn_index;          //stores (in sub synapse) the sub synapse index
     uint _sub_target_index;       //sub target index only for splits
 };
@@ -301,11 +376,11 @@ public:
     QString output_dst_port;
 };
 
-class AbstractionConnection
+class AbstractionConnection: public ArenaAllocated
 {
 public:
     AbstractionConnection();
-    ~AbstractionConnection();
+    virtual ~AbstractionConnection();
     virtual ConnectivityType Type() = 0;
 public:
     PropertyValue *delay;
@@ -323,27 +398,60 @@ public:
     ConnectivityType Type(){return ONE_TO_ONE_CONNECTVITY_TYPE;}
 };
 
-class ConnectionInstance
-{
-public:
-    ConnectionInstance(){}
-public:
-    uint index;
-    int src_neuron;
-    int dst_neuron;
-    double delay;
-};
-
+//compressed sparse row connection list. Rows are the neurons of the component owning the list (src neurons for
+//projections, dst neurons for input remappings) and connections are appended then compressed before use.
+//Split lists are compressed with reindex so that connection indices follow the compressed order.
 class ConnectionList: public AbstractionConnection
 {
 public:
-    ConnectionList(){connection_count = 0;}
-    ~ConnectionList();
+    ConnectionList(bool rows_are_src = true);
+    virtual ~ConnectionList(){}
     ConnectivityType Type(){return LIST_CONNECTVITY_TYPE;}
-public:
-    QMap<int, ConnectionInstance*> connectionIndices; //<index, connection instance>
-    QHash <uint, QHash<uint, ConnectionInstance*> > connectionMatrix; //src, dst -> connection index
-    uint connection_count;
+
+    //building
+    void appendConnection(uint row, uint col, double delay, uint index);
+    void reserve(uint count);               //capacity for count appended connections
+    bool compress(bool reindex = false);    //false if a duplicate connection is found
+    void buildTransposed();                 //optional column view
+    void buildBuckets(const PopulationPartition &row_partition, const PopulationPartition &col_partition); //groups connections by (row sub population, col sub population)
+    void permute(const QVector<uint> &row_permutation, const QVector<uint> &col_permutation);  //renumbers neurons keeping connection indices (empty permutations are the identity)
+
+    //access (once compressed)
+    uint size();
+    uint rowCount();
+    uint rowStart(uint row);
+    uint rowEnd(uint row);
+    int find(uint row, uint col);           //position of connection or -1
+    uint srcNeuron(uint row, uint pos);
+    uint dstNeuron(uint row, uint pos);
+    uint colStart(uint col);                //transposed view
+    uint colEnd(uint col);
+    uint bucketStart(uint row_block);       //buckets of a row block
+    uint bucketEnd(uint row_block);
+
+public:
+    bool rows_are_src;
+    bool materialised;              //generated from fixed probability connectivity by the splitter
+    QVector<uint> row_offsets;      //rowCount()+1 offsets into the connection arrays
+    QVector<uint> cols;
+    QVector<double> delays;
+    QVector<uint> indices;          //connection index (document order when parsed)
+    QVector<uint> parent_indices;   //connection index in the unsplit list of each connection (split projection lists only)
+
+    //transposed view (col -> positions ordered by row)
+    QVector<uint> t_offsets;
+    QVector<uint> t_rows;
+    QVector<uint> t_positions;
+
+    //buckets (row block -> buckets ordered by col block, each ordered by row then col)
+    QVector<uint> block_buckets;    //row block offsets into bucket_cols and bucket_offsets
+    QVector<uint> bucket_cols;      //col block of bucket
+    QVector<uint> bucket_offsets;   //bucket offsets into bucket_rows and bucket_positions
+    QVector<uint> bucket_rows;
+    QVector<uint> bucket_positions;
+
+private:
+    QVector<uint> pending_rows;     //rows of appended connections (cleared by compress)
 };
 
 class FixedProbabilityConnection: public AbstractionConnection
@@ -17,15 +17,64 @@ Parser::Parser(QXmlStreamReader *xml_src, InfoParser *info_parser)
 
     xml = xml_src;
     info = info_parser;
+    deferred_info = false;
+    line_offset = 0;
+    cache = NULL;
 }
 
+void Parser::setXmlSource(QXmlStreamReader *xml_src)
+{
+    xml = xml_src;
+}
+
+void Parser::setDeferredInfo(bool deferred)
+{
+    deferred_info = deferred;
+}
+
+
+void Parser::setLineOffset(qint64 line_offset)
+{
+    this->line_offset = line_offset;
+}
+
+void Parser::setCache(SplitCache *cache)
+{
+    this->cache = cache;
+}
+
+qint64 Parser::lineNumber()
+{
+    return xml->lineNumber() + line_offset;
+}
+
+bool Parser::loadBinaryFile(BinaryConnectionFile &bfile)
+{
+    //decoded connections of an unchanged file are reused from previous splits
+    if ((cache) && (cache->restoreConnections(bfile)))
+        return true;
+    if (!bfile.load())
+        return false;
+    if (cache)
+        cache->storeConnections(bfile);
+    return true;
+}
+
+QString Parser::definitionUrl()
+{
+    //urls are shared by every component of a definition (and between splits when resident)
+    QString url = Parser::getStringAttribute(xml, "url");
+    if (cache)
+        return cache->definition(url);
+    return url;
+}
 
 Population *Parser::parsePopulation()
 {
     //sanity check
     Q_ASSERT(xml->isStartElement() && xml->name() == "Population");
     if (PARSER_DEBUG_OUTPUT)
-        qDebug() << "Parser: Found Population on line " << xml->lineNumber();
+        qDebug() << "Parser: Found Population on line " << lineNumber();
 
     Population *population = new Population();
 
@@ -34,7 +83,7 @@ Population *Parser::parsePopulation()
     if (xml->name() == "Neuron"){
         population->neuron = parseNeuron();
     } else {
-        std::cerr << "Error (line " << xml->lineNumber() << "): Expected 'neuron' element in population instead of '" <<  xml->name().toString().toLocal8Bit().data() << "'" << std::endl;
+        std::cerr << "Error (line " << lineNumber() << "): Expected 'neuron' element in population instead of '" <<  xml->name().toString().toLocal8Bit().data() << "'" << std::endl;
         exit(0);
     }
     //Projections
@@ -45,7 +94,7 @@ Population *Parser::parsePopulation()
             projection->index = proj_index++;
             parsed_projections++;
             if (population->projections[projection->proj_population] != NULL){
-                std::cerr << "Error (line " << xml->lineNumber() << "): Duplicate projection destination found in population" << std::endl;
+                std::cerr << "Error (line " << lineNumber() << "): Duplicate projection destination found in population" << std::endl;
                 exit(0);
             }
             population->projections[projection->proj_population] = projection;
@@ -62,7 +111,7 @@ Neuron *Parser::parseNeuron()
     //sanity check
     Q_ASSERT(xml->isStartElement() && xml->name() == "Neuron");
     if (PARSER_DEBUG_OUTPUT)
-        qDebug() << "Parser: Found Neuron on line " << xml->lineNumber();
+        qDebug() << "Parser: Found Neuron on line " << lineNumber();
 
     ComponentInfo * neuron_info= NULL;
     Neuron *neuron = new Neuron();
@@ -70,18 +119,22 @@ Neuron *Parser::parseNeuron()
     //attributes
     neuron->name = Parser::getStringAttribute(xml, "name");
     neuron->size = Parser::getIntAttribute(xml, "size");
-    neuron->definition_url = Parser::getStringAttribute(xml, "url");
+    neuron->definition_url = definitionUrl();
 
-    //get neuron info
-    neuron_info = info->getComponentInfo(neuron->name);
+    //get neuron info (not available until after the population is parsed if parsing in a single pass)
+    uint neuron_size = neuron->size;
+    if (!deferred_info){
+        neuron_info = info->getComponentInfo(neuron->name);
+        neuron_size = neuron_info->size;
+    }
 
 
     //parse inputs and properties
     while (xml->readNextStartElement()) {
         if (xml->name() == "Property"){
-            neuron->properties.append(parseProperty(neuron_info->size));
+            neuron->properties.append(parseProperty(neuron_size));
         }else if (xml->name() == "Input"){
-            Input *input = parseInput(neuron, neuron_info->size);
+            Input *input = parseInput(neuron, neuron_size);
             QString src = "%1_%2_%3";
             src = src.arg(input->src).arg(input->src_port).arg(input->dst_port);
             neuron->inputs[src] = input;
@@ -99,7 +152,7 @@ Property* Parser::parseProperty(uint comp_size)
     //sanity check
     Q_ASSERT(xml->isStartElement() && xml->name() == "Property");
     if (PARSER_DEBUG_OUTPUT)
-        qDebug() << "Parser: Found Property on line " << xml->lineNumber();
+        qDebug() << "Parser: Found Property on line " << lineNumber();
 
     Property* property = new Property();
 
@@ -119,37 +172,26 @@ Property* Parser::parseProperty(uint comp_size)
         //read value instances
         while (xml->readNextStartElement()) {
             if (xml->name() == "Value"){
-                PropertyValueInstance *prop_inst = new PropertyValueInstance;
                 //index
-                prop_inst->index = Parser::getIntAttribute(xml, "index");
-                if (comp_size <= prop_inst->index)  //set the max index
+                uint index = Parser::getIntAttribute(xml, "index");
+                if (comp_size <= index)  //set the max index
                 {
-                    std::cerr << "Warning (line " << xml->lineNumber() << "): Property index '" << prop_inst->index << "' exceeds maximum index value of '" << (comp_size-1) << "'. Property Instance will be ignored!" << std::endl;
-                    delete prop_inst;
+                    std::cerr << "Warning (line " << lineNumber() << "): Property index '" << index << "' exceeds maximum index value of '" << (comp_size-1) << "'. Property Instance will be ignored!" << std::endl;
                     xml->skipCurrentElement();
                     continue;
                 }
                 //value
-                prop_inst->value = Parser::getDoubleAttribute(xml, "value");
-                //add to property list
-                if (prop_list->valueInstances.contains(prop_inst->index))
-                {
-                    PropertyValueInstance *existing = prop_list->valueInstances[prop_inst->index];
-                    if (existing->value == prop_inst->value)
-                    {
-                        std::cerr << "Warning(line " << xml->lineNumber() << "): Property instance duplicate detected with index " << prop_inst->index << " and same value of " << prop_inst->value << "." << std::endl;
-                    }else{
-                        std::cerr << "Warning(line " << xml->lineNumber() << "): Property instance duplicate detected with index " << prop_inst->index << ". Differing value " << prop_inst->value << " will be ignored!" << std::endl;
-                    }
-                }else{
-                    prop_list->valueInstances[prop_inst->index] = (prop_inst);
-                }
+                prop_list->appendValue(index, Parser::getDoubleAttribute(xml, "value"));
                 xml->skipCurrentElement();
             }
             else
                 xml->skipCurrentElement();
 
         }
+        //duplicates are found once all values are known
+        uint duplicates = prop_list->finalise();
+        if (duplicates > 0)
+            std::cerr << "Warning(line " << lineNumber() << "): " << duplicates << " property instance duplicates detected in property '" << property->name.toLocal8Bit().data() << "'. Values other than the first for each index will be ignored!" << std::endl;
         property->value = (PropertyValue*)prop_list;
     }  else  if (xml->name() == "UniformDistribution"){
         UniformDistPropertyValue *uniform_dist_value = new UniformDistPropertyValue();
@@ -172,7 +214,7 @@ Property* Parser::parseProperty(uint comp_size)
         property->value = (PropertyValue*)poisson_dist_value;
         xml->skipCurrentElement();
     }else {
-        std::cerr << "Error (line " << xml->lineNumber() << "): Expected a value type element in properties instead of '" <<  xml->name().toString().toLocal8Bit().data() << "'" << std::endl;
+        std::cerr << "Error (line " << lineNumber() << "): Expected a value type element in properties instead of '" <<  xml->name().toString().toLocal8Bit().data() << "'" << std::endl;
         exit(0);
     }
 
@@ -185,7 +227,7 @@ Input *Parser::parseInput(Component *component, uint component_size)
     //sanity check
     Q_ASSERT(xml->isStartElement() && xml->name() == "Input");
     if (PARSER_DEBUG_OUTPUT)
-        qDebug() << "Parser: Found input on line " << xml->lineNumber();
+        qDebug() << "Parser: Found input on line " << lineNumber();
 
     Input* input = new Input();
     ComponentInfo *src_info = NULL;
@@ -194,33 +236,38 @@ Input *Parser::parseInput(Component *component, uint component_size)
     input->src_port = Parser::getStringAttribute(xml, "src_port");
     input->dst_port = Parser::getStringAttribute(xml, "dst_port");
     input->src = Parser::getStringAttribute(xml, "src");
-    //check input exists
+    //check input exists (sources not yet parsed are checked by resolveDeferredPopulation when parsing in a single pass)
+    uint src_size = DEFERRED_COMPONENT_SIZE;
     if (!info->componentExists(input->src)){
-        std::cerr << "Error (line " << xml->lineNumber() << "): Input 'src' value of '" << input->src.toLocal8Bit().data() << "' is not found within the model " << std::endl;
-        exit(0);
-    }
-    src_info = info->getComponentInfo(input->src);
-    //check type of input (should already be done via xml validation!)
-    if(src_info->Type() != COMPONENT_TYPE_POPULATION){
-        std::cerr << "Error (line " << xml->lineNumber() << "): Input 'src' value of '" << input->src.toLocal8Bit().data() << "' must be a population (i.e. neuron)!" << std::endl;
-        exit(0);
+        if (!deferred_info){
+            std::cerr << "Error (line " << lineNumber() << "): Input 'src' value of '" << input->src.toLocal8Bit().data() << "' is not found within the model " << std::endl;
+            exit(0);
+        }
+    }else{
+        src_info = info->getComponentInfo(input->src);
+        //check type of input (should already be done via xml validation!)
+        if(src_info->Type() != COMPONENT_TYPE_POPULATION){
+            std::cerr << "Error (line " << lineNumber() << "): Input 'src' value of '" << input->src.toLocal8Bit().data() << "' must be a population (i.e. neuron)!" << std::endl;
+            exit(0);
+        }
+        src_size = src_info->size;
     }
 
     //remapping
-    AbstractionConnection *conn = parseConnectivity(src_info->size-1, component_size-1, false); //hash by destination
+    AbstractionConnection *conn = parseConnectivity(src_size-1, component_size-1, false); //hash by destination
     if (conn == NULL){
-        std::cerr << "Error (line " << xml->lineNumber() << "): Expected connection type element in remapping" << std::endl;
+        std::cerr << "Error (line " << lineNumber() << "): Expected connection type element in remapping" << std::endl;
         exit(0);
     }
     //check dimensionality of remapping for one to one
     if (conn->Type() == ONE_TO_ONE_CONNECTVITY_TYPE){
         //check input size for dimensionality
-        if (src_info->size != component_size){
-            std::cerr <<  "Error (line " << xml->lineNumber() << "): Input size mismatch in between component size '" << component_size << "' and input '" << input->src.toLocal8Bit().data() << "' size '" << src_info->size << "'" << std::endl;
+        if ((src_size != DEFERRED_COMPONENT_SIZE)&&(component_size != DEFERRED_COMPONENT_SIZE)&&(src_size != component_size)){
+            std::cerr <<  "Error (line " << lineNumber() << "): Input size mismatch in between component size '" << component_size << "' and input '" << input->src.toLocal8Bit().data() << "' size '" << src_size << "'" << std::endl;
             exit(0);
         }
         if((component->Type() == COMPONENT_TYPE_WEIGHT_UPDATE)){
-            std::cerr <<  "Error (line " << xml->lineNumber() << "): Componenents of type Synapse or Postsynapse cannot use a one to one remapping. Explicit lists should be used instead!" << std::endl;
+            std::cerr <<  "Error (line " << lineNumber() << "): Componenents of type Synapse or Postsynapse cannot use a one to one remapping. Explicit lists should be used instead!" << std::endl;
             exit(0);
         }
     }
@@ -238,7 +285,7 @@ AbstractionConnection *Parser::parseConnectivity(uint max_src_index, uint max_ds
     AbstractionConnection *connection = NULL;
     xml->readNextStartElement();
     if (xml->name() == "ConnectionList"){
-        ConnectionList *conn_list = new ConnectionList();
+        ConnectionList *conn_list = new ConnectionList(hash_instances_by_src);    //rows are src neurons if hashed by src
         conn_list->delay = NULL;
         //read connection instances
         uint index_count = 0;
@@ -247,120 +294,69 @@ AbstractionConnection *Parser::parseConnectivity(uint max_src_index, uint max_ds
                 int num_connections = Parser::getIntAttribute(xml, "num_connections");
                 int delay_flag = Parser::getIntAttribute(xml, "explicit_delay_flag");
                 QString filename = Parser::getStringAttribute(xml, "file_name");
-                //open binary file
-                QFile mfile(filename);
-                if (!mfile.open(QFile::ReadOnly)) {
-                    std::cerr << "Error (line " << xml->lineNumber() << "): Could not open binary connection file '" << filename.toLocal8Bit().data() << "'!" << std::endl;
+                //bulk load binary file
+                BinaryConnectionFile bfile(filename, num_connections, delay_flag);
+                if (!loadBinaryFile(bfile)){
+                    if (bfile.open_error)
+                        std::cerr << "Error (line " << lineNumber() << "): Could not open binary connection file '" << filename.toLocal8Bit().data() << "'!" << std::endl;
+                    else
+                        std::cerr << "Error (line " << lineNumber() << "): Unexpected end of open binary connection file '" << filename.toLocal8Bit().data() << "'!" << std::endl;
                     exit(0);
                 }
-                QDataStream in(&mfile);
-                in.setVersion(QDataStream::Qt_4_8);
-                for (int i=0; i<num_connections; i++){
-                    uint src_neuron;
-                    uint dst_neuron;
-                    uint delay;
-                    ConnectionInstance *conn_inst;
-
-                    conn_inst = new ConnectionInstance();
-                    conn_inst->index = index_count++;
-
-                    if (in.atEnd()){
-                        std::cerr << "Error (line " << xml->lineNumber() << "): Unexpected end of open binary connection file '" << filename.toLocal8Bit().data() << "'!" << std::endl;
-                        exit(0);
-                    }
-
-                    in >> src_neuron;
-                    if (src_neuron > max_src_index){
-                        std::cerr << "Error (binary file '" << filename.toLocal8Bit().data() << ")': src_neuron value '" << src_neuron << "' exceeds maximim value of '" << max_src_index << "'" << std::endl;
-                        exit(0);
-                    }
-                    conn_inst->src_neuron = src_neuron;
-
-                    in >> dst_neuron;
-                    if (dst_neuron > max_dst_index){
-                        std::cerr << "Error (line '" << filename.toLocal8Bit().data() << "''): dst_neuron value '" << dst_neuron << "' exceeds maximim value of '" << max_dst_index << "'" << std::endl;
-                        exit(0);
-                    }
-                    conn_inst->dst_neuron = dst_neuron;
-
-                    if (delay_flag){
-                        in >> delay;
-                        conn_inst->delay = delay;
-                    }
-
-                    //add to connection list
-                    if (hash_instances_by_src){
-                        conn_list->connectionIndices[conn_inst->index] = conn_inst;
-                        if (conn_list->connectionMatrix[conn_inst->src_neuron][conn_inst->dst_neuron] != NULL){
-                            std::cerr << "Error (binary file " << filename.toLocal8Bit().data() << "): duplicate connection found!"<< std::endl;
-                            exit(0);
-                        }
-                        conn_list->connectionMatrix[conn_inst->src_neuron][conn_inst->dst_neuron] = conn_inst;
-                    }
-                    else{
-                        conn_list->connectionIndices[conn_inst->index] = conn_inst;
-                        if (conn_list->connectionMatrix[conn_inst->dst_neuron][conn_inst->src_neuron] != NULL){
-                            std::cerr << "Error (binary file " << filename.toLocal8Bit().data() << "): duplicate connection found!"<< std::endl;
-                            exit(0);
-                        }
-                        conn_list->connectionMatrix[conn_inst->dst_neuron][conn_inst->src_neuron] = conn_inst;
-                    }
-                    xml->skipCurrentElement();
-
+                if (bfile.max_src_neuron > max_src_index){
+                    std::cerr << "Error (binary file '" << filename.toLocal8Bit().data() << ")': src_neuron value '" << bfile.max_src_neuron << "' exceeds maximim value of '" << max_src_index << "'" << std::endl;
+                    exit(0);
                 }
-                mfile.close();
+                if (bfile.max_dst_neuron > max_dst_index){
+                    std::cerr << "Error (binary file '" << filename.toLocal8Bit().data() << ")': dst_neuron value '" << bfile.max_dst_neuron << "' exceeds maximim value of '" << max_dst_index << "'" << std::endl;
+                    exit(0);
+                }
+
+                //add to connection list (duplicates are found when compressed)
+                const QVector<uint> &rows = hash_instances_by_src ? bfile.src_neurons : bfile.dst_neurons;
+                const QVector<uint> &cols = hash_instances_by_src ? bfile.dst_neurons : bfile.src_neurons;
+                for (int i=0; i<num_connections; i++)
+                    conn_list->appendConnection(rows[i], cols[i], delay_flag ? bfile.delays[i] : 0, index_count++);
+                xml->skipCurrentElement();
             }else if(xml->name() == "Delay"){
                 if (conn_list->delay != NULL){
-                    std::cerr << "Error (line " << xml->lineNumber() << "): Multiple Delay elements found for ConnectionList!" << std::endl;
+                    std::cerr << "Error (line " << lineNumber() << "): Multiple Delay elements found for ConnectionList!" << std::endl;
                     exit(0);
                 }
                 conn_list->delay = parseDelayPropertyValue();
             }else if (xml->name() == "Connection"){
-                ConnectionInstance *conn_inst = new ConnectionInstance;
-                conn_inst->index = index_count++;
-
                 //srcNeuron
                 uint src_neuron = (uint)Parser::getIntAttribute(xml, "src_neuron");
                 if (src_neuron > max_src_index){
-                    std::cerr << "Error (line " << xml->lineNumber() << "): src_neuron value '" << src_neuron << "' exceeds maximim value of '" << max_src_index << "'" << std::endl;
+                    std::cerr << "Error (line " << lineNumber() << "): src_neuron value '" << src_neuron << "' exceeds maximim value of '" << max_src_index << "'" << std::endl;
                     exit(0);
                 }
-                conn_inst->src_neuron = src_neuron;
 
                 //dstNeuron
                 uint dst_neuron = (uint)Parser::getIntAttribute(xml, "dst_neuron");
                 if (dst_neuron > max_dst_index){
-                    std::cerr << "Error (line " << xml->lineNumber() << "): dst_neuron value '" << dst_neuron << "' exceeds maximim value of '" << max_dst_index << "'" << std::endl;
+                    std::cerr << "Error (line " << lineNumber() << "): dst_neuron value '" << dst_neuron << "' exceeds maximim value of '" << max_dst_index << "'" << std::endl;
                     exit(0);
                 }
-                conn_inst->dst_neuron = dst_neuron;
 
                 //delay
-                conn_inst->delay = Parser::getDoubleAttribute(xml, "delay", true);
-
-                //add to connection list
-                if (hash_instances_by_src){
-                    conn_list->connectionIndices[conn_inst->index] = conn_inst;
-                    if (conn_list->connectionMatrix[conn_inst->src_neuron][conn_inst->dst_neuron] != NULL){
-                        std::cerr << "Error (line " << xml->lineNumber() << "): duplicate connection found!"<< std::endl;
-                        exit(0);
-                    }
-                    conn_list->connectionMatrix[conn_inst->src_neuron][conn_inst->dst_neuron] = conn_inst;
-                }
-                else{
-                    conn_list->connectionIndices[conn_inst->index] = conn_inst;
-                    if (conn_list->connectionMatrix[conn_inst->dst_neuron][conn_inst->src_neuron] != NULL){
-                        std::cerr << "Error (line " << xml->lineNumber() << "): duplicate connection found!"<< std::endl;
-                        exit(0);
-                    }
-                    conn_list->connectionMatrix[conn_inst->dst_neuron][conn_inst->src_neuron] = conn_inst;
-                }
+                double delay = Parser::getDoubleAttribute(xml, "delay", true);
+
+                //add to connection list (duplicates are found when compressed)
+                if (hash_instances_by_src)
+                    conn_list->appendConnection(src_neuron, dst_neuron, delay, index_count++);
+                else
+                    conn_list->appendConnection(dst_neuron, src_neuron, delay, index_count++);
                 xml->skipCurrentElement();
             }
             else
                 xml->skipCurrentElement();
 
         }
+        if (!conn_list->compress()){
+            std::cerr << "Error (line " << lineNumber() << "): duplicate connection found in ConnectionList!"<< std::endl;
+            exit(0);
+        }
         if (PARSER_DEBUG_OUTPUT)
             qDebug() << "Parser: Found ConnectionList";
         connection = (AbstractionConnection*) conn_list;
@@ -372,7 +368,7 @@ AbstractionConnection *Parser::parseConnectivity(uint max_src_index, uint max_ds
             one_to_one->delay = parseDelayPropertyValue();
         }else
         {
-            std::cerr << "Error (line " << xml->lineNumber() << "): Expected 'Delay' element in OneToOneConnection instead of '"<<  xml->name().toString().toLocal8Bit().data() << "'" << std::endl;
+            std::cerr << "Error (line " << lineNumber() << "): Expected 'Delay' element in OneToOneConnection instead of '"<<  xml->name().toString().toLocal8Bit().data() << "'" << std::endl;
             exit(0);
         }
         if (PARSER_DEBUG_OUTPUT)
@@ -387,7 +383,7 @@ AbstractionConnection *Parser::parseConnectivity(uint max_src_index, uint max_ds
             all_to_all->delay = parseDelayPropertyValue();
         }else
         {
-            std::cerr << "Error (line " << xml->lineNumber() << "): Expected 'Delay' element in AllToAllConnection instead of '"<<  xml->name().toString().toLocal8Bit().data() << "'" << std::endl;
+            std::cerr << "Error (line " << lineNumber() << "): Expected 'Delay' element in AllToAllConnection instead of '"<<  xml->name().toString().toLocal8Bit().data() << "'" << std::endl;
             exit(0);
         }
         if (PARSER_DEBUG_OUTPUT)
@@ -407,7 +403,7 @@ AbstractionConnection *Parser::parseConnectivity(uint max_src_index, uint max_ds
             fixed_prob_conn->delay = parseDelayPropertyValue();
         }else
         {
-            std::cerr << "Error (line " << xml->lineNumber() << "): Expected 'Delay' element in FixedProbabilityConnection instead of '"<<  xml->name().toString().toLocal8Bit().data() << "'" << std::endl;
+            std::cerr << "Error (line " << lineNumber() << "): Expected 'Delay' element in FixedProbabilityConnection instead of '"<<  xml->name().toString().toLocal8Bit().data() << "'" << std::endl;
             exit(0);
         }
 
@@ -416,7 +412,7 @@ AbstractionConnection *Parser::parseConnectivity(uint max_src_index, uint max_ds
         xml->skipCurrentElement();
         connection = (AbstractionConnection*) fixed_prob_conn;
     }else{
-        std::cerr << "Error (line " << xml->lineNumber() << "): Unknown connectivity type '"<<  xml->name().toString().toLocal8Bit().data() << "' found!" << std::endl;
+        std::cerr << "Error (line " << lineNumber() << "): Unknown connectivity type '"<<  xml->name().toString().toLocal8Bit().data() << "' found!" << std::endl;
         exit(0);
     }
 
@@ -430,37 +426,41 @@ Projection *Parser::parseProjection(Neuron* neuron)
     //sanity check
     Q_ASSERT(xml->isStartElement() && xml->name() == "Projection");
     if (PARSER_DEBUG_OUTPUT)
-        qDebug() << "Parser: Found Projection on line " << xml->lineNumber();
+        qDebug() << "Parser: Found Projection on line " << lineNumber();
 
     Projection *projection = new Projection();
 
-    if (info->getSplitterMode() == SPLITMODE_PROJ_DEF_AT_SRC)
+    if (deferred_info)  //no info parse so the splitter mode is set (and checked) as projections are found
+        projection->proj_population = info->parseProjectionPopulation(xml);
+    else if (info->getSplitterMode() == SPLITMODE_PROJ_DEF_AT_SRC)
         projection->proj_population = Parser::getStringAttribute(xml, "dst_population");
     else if (info->getSplitterMode() == SPLITMODE_PROJ_DEF_AT_DST)
         projection->proj_population = Parser::getStringAttribute(xml, "src_population");
 
 
-    //check dst
+    //check dst (populations not yet parsed are checked by resolveDeferredPopulation when parsing in a single pass)
+    uint dst_pop_size = DEFERRED_COMPONENT_SIZE;
     if (!info->componentExists(projection->proj_population)){
-        std::cerr << "Error (line " << xml->lineNumber() << "): Projection destination '" << projection->proj_population.toLocal8Bit().data() << "' not found in model." << std::endl;
-        exit(0);
-    }
-    ComponentInfo *dst_info = info->getComponentInfo(projection->proj_population);
-    if (dst_info->Type() != COMPONENT_TYPE_POPULATION)
-    {
-        std::cerr << "Error (line " << xml->lineNumber() << "): Projection destination '" << projection->proj_population.toLocal8Bit().data() << "' is not a popultion name." << std::endl;
-        exit(0);
+        if (!deferred_info){
+            std::cerr << "Error (line " << lineNumber() << "): Projection destination '" << projection->proj_population.toLocal8Bit().data() << "' not found in model." << std::endl;
+            exit(0);
+        }
+    }else{
+        ComponentInfo *dst_info = info->getComponentInfo(projection->proj_population);
+        if (dst_info->Type() != COMPONENT_TYPE_POPULATION)
+        {
+            std::cerr << "Error (line " << lineNumber() << "): Projection destination '" << projection->proj_population.toLocal8Bit().data() << "' is not a popultion name." << std::endl;
+            exit(0);
+        }
+        dst_pop_size = dst_info->size;
     }
 
-    //get info
-    PopulationInfo * dst_pop_info = (PopulationInfo*)dst_info;
-
     while (xml->readNextStartElement()) {
         if (xml->name() == "Synapse"){
-            Synapse *target = parseTarget(neuron, dst_pop_info->size);
+            Synapse *target = parseTarget(neuron, dst_pop_size);
             if (projection->synapses.contains(target->weightupdate->name))
             {
-                std::cerr << "Error (line " << xml->lineNumber() << "): Duplicate Target Synapse name found in Projection" << std::endl;
+                std::cerr << "Error (line " << lineNumber() << "): Duplicate Target Synapse name found in Projection" << std::endl;
                 exit(0);
             }
             projection->synapses[target->weightupdate->name] = target;
@@ -477,7 +477,7 @@ Synapse *Parser::parseTarget(Neuron *neuron, uint dst_pop_size)
     //sanity check
     Q_ASSERT(xml->isStartElement() && xml->name() == "Synapse");
     if (PARSER_DEBUG_OUTPUT)
-        qDebug() << "Parser: Found Target on line " << xml->lineNumber();
+        qDebug() << "Parser: Found Target on line " << lineNumber();
 
     Synapse *target = new Synapse();
 
@@ -485,7 +485,7 @@ Synapse *Parser::parseTarget(Neuron *neuron, uint dst_pop_size)
     AbstractionConnection *conn = parseConnectivity(neuron->size-1, dst_pop_size-1, true);
     if (conn == NULL)
     {
-        std::cerr << "Error (line " << xml->lineNumber() << "): Expected Connectivity type element in Target instead of '" <<  xml->name().toString().toLocal8Bit().data() << "'" << std::endl;
+        std::cerr << "Error (line " << lineNumber() << "): Expected Connectivity type element in Target instead of '" <<  xml->name().toString().toLocal8Bit().data() << "'" << std::endl;
         exit(0);
     }
     target->connection = conn;
@@ -497,12 +497,13 @@ Synapse *Parser::parseTarget(Neuron *neuron, uint dst_pop_size)
         switch(target->connection->Type()){
             case(ALL_TO_ALL_CONNECTVITY_TYPE):
             case(FIXED_PROBABILITY_CONNECTVITY_TYPE):{
-                synpase_size *= neuron->size;
+                if (dst_pop_size != DEFERRED_COMPONENT_SIZE)
+                    synpase_size *= neuron->size;
                 break;
             }
             case(LIST_CONNECTVITY_TYPE):{
                 ConnectionList * conn_list = (ConnectionList*) target->connection;
-                synpase_size = conn_list->connectionIndices.values().size();
+                synpase_size = conn_list->size();
                 break;
             }
             default: //ONE_TO_ONE proj_dst_size and neuron->size should be equal!
@@ -513,7 +514,7 @@ Synapse *Parser::parseTarget(Neuron *neuron, uint dst_pop_size)
         synapse->target_connectivity = target->connection;
         target->weightupdate = synapse;
     } else {
-        std::cerr << "Error (line " << xml->lineNumber() << "): Expected 'Synapse' element in Target instead of '" <<  xml->name().toString().toLocal8Bit().data() << "'" << std::endl;
+        std::cerr << "Error (line " << lineNumber() << "): Expected 'Synapse' element in Target instead of '" <<  xml->name().toString().toLocal8Bit().data() << "'" << std::endl;
         exit(0);
     }
 
@@ -527,7 +528,7 @@ Synapse *Parser::parseTarget(Neuron *neuron, uint dst_pop_size)
             postsynpase = parsePostsynapse(neuron->size);
         target->postsynapse = postsynpase;
     } else {
-        std::cerr << "Error (line " << xml->lineNumber() << "): Expected 'PostSynapse' element in Target instead of '" <<  xml->name().toString().toLocal8Bit().data() << "'" << std::endl;
+        std::cerr << "Error (line " << lineNumber() << "): Expected 'PostSynapse' element in Target instead of '" <<  xml->name().toString().toLocal8Bit().data() << "'" << std::endl;
         exit(0);
     }
 
@@ -540,13 +541,13 @@ WeightUpdate *Parser::parseSynapse(uint synapse_size)
     //sanity check
     Q_ASSERT(xml->isStartElement() && xml->name() == "WeightUpdate");
     if (PARSER_DEBUG_OUTPUT)
-        qDebug() << "Parser: Found Synapse on line " << xml->lineNumber();
+        qDebug() << "Parser: Found Synapse on line " << lineNumber();
 
     WeightUpdate *weight_update = new WeightUpdate();
 
     //attributes
     weight_update->name = Parser::getStringAttribute(xml, "name");
-    weight_update->definition_url = Parser::getStringAttribute(xml, "url");
+    weight_update->definition_url = definitionUrl();
     weight_update->input_src_port = Parser::getStringAttribute(xml, "input_src_port");
     weight_update->input_dst_port = Parser::getStringAttribute(xml, "input_dst_port");
 
@@ -576,13 +577,13 @@ Postsynapse *Parser::parsePostsynapse(uint postsynapse_size)
     //sanity check
     Q_ASSERT(xml->isStartElement() && xml->name() == "PostSynapse");
     if (PARSER_DEBUG_OUTPUT)
-        qDebug() << "Parser: Found PostSynapse on line " << xml->lineNumber();
+        qDebug() << "Parser: Found PostSynapse on line " << lineNumber();
 
     Postsynapse *postsynapse = new Postsynapse();
 
     //attributes
     postsynapse->name = Parser::getStringAttribute(xml, "name");
-    postsynapse->definition_url = Parser::getStringAttribute(xml, "url");
+    postsynapse->definition_url = definitionUrl();
     postsynapse->input_src_port = Parser::getStringAttribute(xml, "input_src_port");
     postsynapse->input_dst_port = Parser::getStringAttribute(xml, "input_dst_port");
     postsynapse->output_src_port = Parser::getStringAttribute(xml, "output_src_port");
@@ -612,7 +613,7 @@ PropertyValue *Parser::parseDelayPropertyValue()
     //sanity check
     Q_ASSERT(xml->isStartElement() && xml->name() == "Delay");
     if (PARSER_DEBUG_OUTPUT)
-        qDebug() << "Parser: Found Delay on line " << xml->lineNumber();
+        qDebug() << "Parser: Found Delay on line " << lineNumber();
 
     PropertyValue* value = NULL;
 
@@ -640,7 +641,7 @@ PropertyValue *Parser::parseDelayPropertyValue()
         poisson_dist_value->mean = Parser::getDoubleAttribute(xml, "mean");
         value = (PropertyValue*)poisson_dist_value;
     }else {
-        std::cerr << "Error (line " << xml->lineNumber() << "): Expected a FixedValue or Ditribution type element in Delay instead of '" <<  xml->name().toString().toLocal8Bit().data() << "'" << std::endl;
+        std::cerr << "Error (line " << lineNumber() << "): Expected a FixedValue or Ditribution type element in Delay instead of '" <<  xml->name().toString().toLocal8Bit().data() << "'" << std::endl;
         exit(0);
     }
 
@@ -650,6 +651,112 @@ PropertyValue *Parser::parseDelayPropertyValue()
     return value;
 }
 
+void Parser::resolveDeferredPopulation(Population *population)
+{
+    //performs the size and name checks which could not be made whilst parsing in a single pass (requires info for all populations)
+    Neuron *neuron = population->neuron;
+    resolveDeferredInputs(neuron, neuron->size);
+
+    for (QHash<QString, Projection*>::const_iterator p = population->projections.constBegin(); p != population->projections.constEnd(); ++p){
+        Projection *projection = p.value();
+        if (!info->componentExists(projection->proj_population)){
+            std::cerr << "Error: Projection destination '" << projection->proj_population.toLocal8Bit().data() << "' not found in model." << std::endl;
+            exit(0);
+        }
+        ComponentInfo *dst_info = info->getComponentInfo(projection->proj_population);
+        if (dst_info->Type() != COMPONENT_TYPE_POPULATION)
+        {
+            std::cerr << "Error: Projection destination '" << projection->proj_population.toLocal8Bit().data() << "' is not a popultion name." << std::endl;
+            exit(0);
+        }
+        uint dst_pop_size = dst_info->size;
+
+        for (QHash<QString, Synapse*>::const_iterator s = projection->synapses.constBegin(); s != projection->synapses.constEnd(); ++s){
+            Synapse *synapse = s.value();
+            resolveDeferredConnectivity(synapse->connection, neuron->size-1, dst_pop_size-1);
+
+            //weight update size (as parseTarget)
+            uint synapse_size = dst_pop_size;
+            switch(synapse->connection->Type()){
+                case(ALL_TO_ALL_CONNECTVITY_TYPE):
+                case(FIXED_PROBABILITY_CONNECTVITY_TYPE):{
+                    synapse_size *= neuron->size;
+                    break;
+                }
+                case(LIST_CONNECTVITY_TYPE):{
+                    synapse_size = ((ConnectionList*)synapse->connection)->size();
+                    break;
+                }
+                default:
+                    break;
+            }
+            resolveDeferredProperties(synapse->weightupdate, synapse_size);
+
+            //postsynapse size
+            uint postsynapse_size = neuron->size;
+            if (info->getSplitterMode() == SPLITMODE_PROJ_DEF_AT_SRC)
+                postsynapse_size = dst_pop_size;
+            resolveDeferredProperties(synapse->postsynapse, postsynapse_size);
+            resolveDeferredInputs(synapse->postsynapse, postsynapse_size);
+        }
+    }
+}
+
+void Parser::resolveDeferredProperties(Component *component, uint comp_size)
+{
+    for (int i=0; i<component->properties.size(); i++){
+        Property *property = component->properties[i];
+        if (property->value->Type() != VALUE_LIST_TYPE)
+            continue;
+        PropertyValueList *prop_list = (PropertyValueList*)property->value;
+        for (int index=prop_list->nextIndex((int)comp_size-1); index>=0; index=prop_list->nextIndex(index))
+            std::cerr << "Warning: Property index '" << index << "' exceeds maximum index value of '" << (comp_size-1) << "' in component '" << component->name.toLocal8Bit().data() << "'. Property Instance will be ignored!" << std::endl;
+        prop_list->truncate(comp_size);
+    }
+}
+
+void Parser::resolveDeferredInputs(Component *component, uint comp_size)
+{
+    for (QHash<QString, Input*>::const_iterator i = component->inputs.constBegin(); i != component->inputs.constEnd(); ++i){
+        Input *input = i.value();
+        if (!info->componentExists(input->src)){
+            std::cerr << "Error: Input 'src' value of '" << input->src.toLocal8Bit().data() << "' is not found within the model " << std::endl;
+            exit(0);
+        }
+        ComponentInfo *src_info = info->getComponentInfo(input->src);
+        if(src_info->Type() != COMPONENT_TYPE_POPULATION){
+            std::cerr << "Error: Input 'src' value of '" << input->src.toLocal8Bit().data() << "' must be a population (i.e. neuron)!" << std::endl;
+            exit(0);
+        }
+        if ((input->remapping->Type() == ONE_TO_ONE_CONNECTVITY_TYPE)&&(src_info->size != comp_size)){
+            std::cerr <<  "Error: Input size mismatch in between component size '" << comp_size << "' and input '" << input->src.toLocal8Bit().data() << "' size '" << src_info->size << "'" << std::endl;
+            exit(0);
+        }
+        resolveDeferredConnectivity(input->remapping, src_info->size-1, comp_size-1);
+    }
+}
+
+void Parser::resolveDeferredConnectivity(AbstractionConnection *connection, uint max_src_index, uint max_dst_index)
+{
+    if (connection->Type() != LIST_CONNECTVITY_TYPE)
+        return;
+    ConnectionList *conn_list = (ConnectionList*)connection;
+    for (uint r=0; r<conn_list->rowCount(); r++){
+        for (uint p=conn_list->rowStart(r); p<conn_list->rowEnd(r); p++){
+            uint src_neuron = conn_list->srcNeuron(r, p);
+            uint dst_neuron = conn_list->dstNeuron(r, p);
+            if (src_neuron > max_src_index){
+                std::cerr << "Error: src_neuron value '" << src_neuron << "' exceeds maximim value of '" << max_src_index << "'" << std::endl;
+                exit(0);
+            }
+            if (dst_neuron > max_dst_index){
+                std::cerr << "Error: dst_neuron value '" << dst_neuron << "' exceeds maximim value of '" << max_dst_index << "'" << std::endl;
+                exit(0);
+            }
+        }
+    }
+}
+
 Experiment *Parser::parseExperiment(QString input_path)
 {
     //sanity check
@@ -810,3 +917,10 @@ uint Parser::getParsedInputCount()
     return parsed_inputs;
 }
 
+void Parser::addParsedCounts(Parser *parser)
+{
+    parsed_populations += parser->parsed_populations;
+    parsed_projections += parser->parsed_projections;
+    parsed_inputs += parser->parsed_inputs;
+    parsed_instances += parser->parsed_instances;
+}
@@ -4,12 +4,23 @@
 #include <QXmlStreamReader>
 #include "modelobjects.h"
 #include "infoparser.h"
+#include "binaryconnectionfile.h"
+#include "splitcache.h"
+
+//component size used while parsing in single pass mode before the size of a referenced population is known
+#define DEFERRED_COMPONENT_SIZE 0xFFFFFFFF
 
 class Parser
 {
 public:
     Parser(QXmlStreamReader *xml_src, InfoParser *info_parser);
 
+    void setXmlSource(QXmlStreamReader *xml_src);
+    void setDeferredInfo(bool deferred);
+    void setLineOffset(qint64 line_offset);
+    void setCache(SplitCache *cache);
+    void resolveDeferredPopulation(Population *population);
+
     Population* parsePopulation();
     Neuron* parseNeuron();
     Property* parseProperty(uint comp_size);
@@ -38,10 +49,24 @@ public:
     uint getParsedPopulationCount();
     uint getParsedProjectionCount();
     uint getParsedInputCount();
+    void addParsedCounts(Parser *parser);
+
+private:
+    qint64 lineNumber();
+    bool loadBinaryFile(BinaryConnectionFile &bfile);
+    QString definitionUrl();
+
+    //deferred checks (single pass parsing)
+    void resolveDeferredProperties(Component *component, uint comp_size);
+    void resolveDeferredInputs(Component *component, uint comp_size);
+    void resolveDeferredConnectivity(AbstractionConnection *connection, uint max_src_index, uint max_dst_index);
 
 private:
     QXmlStreamReader *xml;
     InfoParser *info;
+    bool deferred_info;     //component info of populations is not available until after the population has been parsed
+    qint64 line_offset;     //line of the parsed xml within the network file (when parsing a population slice of the file)
+    SplitCache *cache;      //binary connections and definition urls of previous splits (NULL if not resident)
 
     uint parsed_populations;
     uint parsed_projections;
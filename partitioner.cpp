@@ -0,0 +1,204 @@
+#include "partitioner.h"
+
+#include <QStringList>
+#include <QDebug>
+#include <iostream>
+
+
+Partitioner::Partitioner(InfoParser *info)
+{
+    this->info = info;
+}
+
+void Partitioner::addPopulation(Population *population)
+{
+    QString pop_name = population->neuron->name;
+    uint pop_size = population->neuron->size;
+    neuronCosts(pop_name);
+
+    //inputs to the neuron
+    addInputCosts(population->neuron, neuronCosts(pop_name));
+
+    //synapses are a cost of the dst population (the population itself when projections are defined at dst)
+    bool defined_at_dst = (info->getSplitterMode() == SPLITMODE_PROJ_DEF_AT_DST);
+    for (QHash<QString, Projection*>::const_iterator p = population->projections.constBegin(); p != population->projections.constEnd(); ++p){
+        Projection *projection = p.value();
+        if (!info->componentExists(projection->proj_population) || (info->getComponentInfo(projection->proj_population)->Type() != COMPONENT_TYPE_POPULATION))
+            continue;   //reported by the splitter
+        QString dst_name = defined_at_dst ? pop_name : projection->proj_population;
+        uint src_size = defined_at_dst ? info->getComponentInfo(projection->proj_population)->size : pop_size;
+
+        for (QHash<QString, Synapse*>::const_iterator s = projection->synapses.constBegin(); s != projection->synapses.constEnd(); ++s){
+            Synapse *synapse = s.value();
+            //rows of connection lists are neurons of the population the projection is defined in
+            addConnectionCosts(synapse->connection, neuronCosts(dst_name), src_size, defined_at_dst, PARTITION_SYNAPSE_COST);
+            addInputCosts(synapse->postsynapse, neuronCosts(dst_name));
+            if (synapse->connection->Type() == ONE_TO_ONE_CONNECTVITY_TYPE)
+                linkPopulations(pop_name, projection->proj_population);
+        }
+    }
+}
+
+void Partitioner::balance()
+{
+    //group populations which must share a partition
+    QHash<QString, QStringList> members;
+    for (QHash<QString, QVector<double> >::const_iterator i = neuron_costs.constBegin(); i != neuron_costs.constEnd(); ++i)
+        members[groupName(i.key())].append(i.key());
+
+    for (QHash<QString, QStringList>::const_iterator g = members.constBegin(); g != members.constEnd(); ++g){
+        const QStringList &group = g.value();
+        QVector<double> costs = neuron_costs[group[0]];
+        uint max_size = info->getPartitionSize(group[0]);
+        for (int m=1; m<group.size(); m++){
+            const QVector<double> &member_costs = neuron_costs[group[m]];
+            for (int n=0; n<costs.size(); n++)
+                costs[n] += member_costs[n];
+            max_size = qMin(max_size, info->getPartitionSize(group[m]));
+        }
+
+        QVector<uint> offsets = balancedOffsets(costs, max_size);
+        for (int m=0; m<group.size(); m++)
+            info->setPopulationPartition(group[m], offsets);
+    }
+}
+
+QVector<double> &Partitioner::neuronCosts(QString pop_name)
+{
+    if (!neuron_costs.contains(pop_name))
+        neuron_costs[pop_name] = QVector<double>(info->getComponentInfo(pop_name)->size, PARTITION_NEURON_COST);
+    return neuron_costs[pop_name];
+}
+
+void Partitioner::addConnectionCosts(AbstractionConnection *connection, QVector<double> &dst_costs, uint src_size, bool dst_are_rows, double cost)
+{
+    switch(connection->Type()){
+        case(ALL_TO_ALL_CONNECTVITY_TYPE):{
+            for (int n=0; n<dst_costs.size(); n++)
+                dst_costs[n] += src_size*cost;
+            break;
+        }
+        case(ONE_TO_ONE_CONNECTVITY_TYPE):{
+            for (int n=0; n<dst_costs.size(); n++)
+                dst_costs[n] += cost;
+            break;
+        }
+        case(FIXED_PROBABILITY_CONNECTVITY_TYPE):{
+            double probability = ((FixedProbabilityConnection*)connection)->probability;
+            for (int n=0; n<dst_costs.size(); n++)
+                dst_costs[n] += probability*src_size*cost;
+            break;
+        }
+        case(LIST_CONNECTVITY_TYPE):{
+            ConnectionList *connection_list = (ConnectionList*)connection;
+            double list_cost = cost*(PARTITION_LIST_SYNAPSE_COST/PARTITION_SYNAPSE_COST);
+            if (dst_are_rows){
+                uint rows = qMin(connection_list->rowCount(), (uint)dst_costs.size());
+                for (uint r=0; r<rows; r++)
+                    dst_costs[r] += (connection_list->rowEnd(r) - connection_list->rowStart(r))*list_cost;
+            }else{
+                for (int c=0; c<connection_list->cols.size(); c++){
+                    if (connection_list->cols[c] < (uint)dst_costs.size())
+                        dst_costs[connection_list->cols[c]] += list_cost;
+                }
+            }
+            break;
+        }
+        default:{
+            break;
+        }
+    }
+}
+
+void Partitioner::addInputCosts(Component *component, QVector<double> &dst_costs)
+{
+    //rows of input remappings are the component (dst) neurons
+    for (QHash<QString, Input*>::const_iterator i = component->inputs.constBegin(); i != component->inputs.constEnd(); ++i){
+        Input *input = i.value();
+        if (!info->componentExists(input->src))
+            continue;
+        uint src_size = info->getComponentInfo(input->src)->size;
+        addConnectionCosts(input->remapping, dst_costs, src_size, true, PARTITION_INPUT_COST);
+        if ((component->Type() == COMPONENT_TYPE_POPULATION) && (input->remapping->Type() == ONE_TO_ONE_CONNECTVITY_TYPE))
+            linkPopulations(component->name, input->src);
+    }
+}
+
+void Partitioner::linkPopulations(QString pop_name_a, QString pop_name_b)
+{
+    if (info->getComponentInfo(pop_name_b)->Type() != COMPONENT_TYPE_POPULATION)
+        return;
+    if (info->getComponentInfo(pop_name_a)->size != info->getComponentInfo(pop_name_b)->size)
+        return;     //reported by the splitter
+    neuronCosts(pop_name_b);
+    QString group_a = groupName(pop_name_a);
+    QString group_b = groupName(pop_name_b);
+    if (group_a != group_b)
+        groups[group_b] = group_a;
+}
+
+QString Partitioner::groupName(QString pop_name)
+{
+    while (groups.contains(pop_name))
+        pop_name = groups[pop_name];
+    return pop_name;
+}
+
+QVector<uint> Partitioner::balancedOffsets(const QVector<double> &costs, uint max_size)
+{
+    //contiguous partition minimising the maximum sub population cost without exceeding max_size neurons. The size limit
+    //leaves the uniform sub population count no slack when the population is a multiple of max_size, so expensive
+    //neurons may be spread over more sub populations (bounded by PARTITION_MAX_PART_FACTOR times the uniform count)
+    uint parts = (costs.size() + max_size - 1) / max_size;
+    uint max_parts = parts * PARTITION_MAX_PART_FACTOR;
+    double total = 0;
+    double max_neuron = 0;
+    for (int n=0; n<costs.size(); n++){
+        total += costs[n];
+        max_neuron = qMax(max_neuron, costs[n]);
+    }
+
+    //bisect the maximum sub population cost down to the ideal cost of the uniform count, so further sub populations are
+    //only added while they lower the cost towards that of a perfect balance (uniform costs keep the uniform partition)
+    double lower = qMax(max_neuron, total/qMax(parts, 1u));
+    double upper = total;
+    if (greedyOffsets(costs, max_size, lower, NULL) <= max_parts)
+        upper = lower;
+    for (int i=0; (i<PARTITION_BALANCE_ITERATIONS) && (upper > lower); i++){
+        double mid = (lower + upper)/2;
+        if (greedyOffsets(costs, max_size, mid, NULL) <= max_parts)
+            upper = mid;
+        else
+            lower = mid;
+    }
+
+    QVector<uint> offsets;
+    greedyOffsets(costs, max_size, upper, &offsets);
+    return offsets;
+}
+
+uint Partitioner::greedyOffsets(const QVector<double> &costs, uint max_size, double max_cost, QVector<uint> *offsets)
+{
+    uint count = 0;
+    uint size = 0;
+    double cost = 0;
+    if (offsets)
+        offsets->append(0);
+    for (int n=0; n<costs.size(); n++){
+        if ((size > 0) && ((size == max_size) || (cost + costs[n] > max_cost))){
+            count++;
+            if (offsets)
+                offsets->append(n);
+            size = 0;
+            cost = 0;
+        }
+        size++;
+        cost += costs[n];
+    }
+    if (size > 0){
+        count++;
+        if (offsets)
+            offsets->append(costs.size());
+    }
+    return count;
+}
@@ -0,0 +1,43 @@
+#ifndef PARTITIONER_H
+#define PARTITIONER_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include "modelobjects.h"
+#include "infoparser.h"
+
+//relative cost of updating a neuron and of delivering a synapse or input connection each time step
+#define PARTITION_NEURON_COST 10.0
+#define PARTITION_SYNAPSE_COST 1.0
+#define PARTITION_LIST_SYNAPSE_COST 1.5     //explicit connections are looked up rather than generated
+#define PARTITION_INPUT_COST 1.0
+#define PARTITION_BALANCE_ITERATIONS 64
+#define PARTITION_MAX_PART_FACTOR 2          //balanced partitions use at most this many times the uniform sub population count
+
+//cost model partitioner which replaces the uniform partitions of populations with contiguous sub populations of balanced work
+//the connectivity of every population is required so this runs on fully parsed populations before any are split
+class Partitioner
+{
+public:
+    Partitioner(InfoParser *info);
+
+    void addPopulation(Population *population);     //adds the neuron, incoming synapse and input costs of a parsed population
+    void balance();                                 //sets a balanced partition for each population in the info parser
+
+private:
+    QVector<double> &neuronCosts(QString pop_name);
+    void addConnectionCosts(AbstractionConnection *connection, QVector<double> &dst_costs, uint src_size, bool dst_are_rows, double cost);
+    void addInputCosts(Component *component, QVector<double> &dst_costs);
+    void linkPopulations(QString pop_name_a, QString pop_name_b);
+    QString groupName(QString pop_name);
+    QVector<uint> balancedOffsets(const QVector<double> &costs, uint max_size);
+    uint greedyOffsets(const QVector<double> &costs, uint max_size, double max_cost, QVector<uint> *offsets);
+
+private:
+    InfoParser *info;
+    QHash<QString, QVector<double> > neuron_costs;  //estimated cost of each neuron by population name
+    QHash<QString, QString> groups;                 //populations connected one to one must share a partition
+};
+
+#endif // PARTITIONER_H
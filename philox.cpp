@@ -0,0 +1,30 @@
+#include "philox.h"
+
+void Philox4x32::generate(const quint32 counter[4], const quint32 key[2], quint32 result[4])
+{
+    quint32 c0 = counter[0];
+    quint32 c1 = counter[1];
+    quint32 c2 = counter[2];
+    quint32 c3 = counter[3];
+    quint32 k0 = key[0];
+    quint32 k1 = key[1];
+
+    for (int r=0; r<PHILOX_ROUNDS; r++){
+        quint64 product0 = (quint64)PHILOX_M0 * c0;
+        quint64 product1 = (quint64)PHILOX_M1 * c2;
+        quint32 hi0 = (quint32)(product0 >> 32);
+        quint32 hi1 = (quint32)(product1 >> 32);
+        c0 = hi1 ^ c1 ^ k0;
+        c1 = (quint32)product1;
+        c2 = hi0 ^ c3 ^ k1;
+        c3 = (quint32)product0;
+        //bump key
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    result[0] = c0;
+    result[1] = c1;
+    result[2] = c2;
+    result[3] = c3;
+}
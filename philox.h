@@ -0,0 +1,21 @@
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <QtGlobal>
+
+#define PHILOX_ROUNDS 10
+#define PHILOX_M0 0xD2511F53u     //round multipliers
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u     //key schedule increments
+#define PHILOX_W1 0xBB67AE85u
+
+//Philox4x32-10 counter based random number generator (Salmon et al. 2011). Each (key, counter) pair maps to four
+//independent uniform 32 bit values so any value can be generated without generating those before it, which keeps
+//generated connectivity independent of the order (and thread) in which it is generated.
+class Philox4x32
+{
+public:
+    static void generate(const quint32 counter[4], const quint32 key[2], quint32 result[4]);
+};
+
+#endif // PHILOX_H
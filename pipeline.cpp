@@ -0,0 +1,34 @@
+#include "pipeline.h"
+
+
+PipelineItem::PipelineItem()
+{
+    population = NULL;
+    arena = NULL;
+    sub_pops = NULL;
+    sub_pop_count = 0;
+}
+
+PipelineQueue::PipelineQueue(int capacity)
+{
+    this->capacity = capacity;
+}
+
+void PipelineQueue::push(PipelineItem *item)
+{
+    QMutexLocker locker(&mutex);
+    while (items.size() >= capacity)
+        not_full.wait(&mutex);
+    items.enqueue(item);
+    not_empty.wakeOne();
+}
+
+PipelineItem *PipelineQueue::pop()
+{
+    QMutexLocker locker(&mutex);
+    while (items.isEmpty())
+        not_empty.wait(&mutex);
+    PipelineItem *item = items.dequeue();
+    not_full.wakeOne();
+    return item;
+}
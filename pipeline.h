@@ -0,0 +1,41 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include "modelobjects.h"
+
+#define PIPELINE_QUEUE_SIZE 2   //populations held between pipeline stages (bounds memory)
+
+//population and its sub populations passed between the stages of the pipeline
+class PipelineItem
+{
+public:
+    PipelineItem();
+
+public:
+    Population *population;
+    Arena *arena;           //owns the population and its sub populations
+    Population *sub_pops;
+    uint sub_pop_count;
+};
+
+//blocking fifo of bounded size between two pipeline stages (a NULL item marks the end of the stream)
+class PipelineQueue
+{
+public:
+    PipelineQueue(int capacity = PIPELINE_QUEUE_SIZE);
+
+    void push(PipelineItem *item);      //blocks while the queue is full
+    PipelineItem *pop();                //blocks while the queue is empty
+
+private:
+    QMutex mutex;
+    QWaitCondition not_empty;
+    QWaitCondition not_full;
+    QQueue<PipelineItem*> items;
+    int capacity;
+};
+
+#endif // PIPELINE_H
@@ -0,0 +1,287 @@
+#include "planner.h"
+#include "aliaswriter.h"
+
+#include <QStringList>
+#include <iostream>
+#include <algorithm>
+
+
+//orders populations by document order
+static bool globalIndexLessThan(PopulationInfo *a, PopulationInfo *b)
+{
+    return a->global_index < b->global_index;
+}
+
+SplitPlanner::SplitPlanner(InfoParser *info)
+{
+    this->info = info;
+}
+
+void SplitPlanner::plan()
+{
+    QList<ComponentInfo*> components = info->getComponentInfoList();
+
+    //populations in document order
+    QList<PopulationInfo*> pop_infos;
+    for (int i=0; i<components.size(); i++){
+        if (components[i]->Type() == COMPONENT_TYPE_POPULATION)
+            pop_infos.append((PopulationInfo*)components[i]);
+    }
+    std::sort(pop_infos.begin(), pop_infos.end(), globalIndexLessThan);
+    for (int i=0; i<pop_infos.size(); i++){
+        PopulationPlan population;
+        population.name = pop_infos[i]->name;
+        population.size = pop_infos[i]->size;
+        population.sub_populations = pop_infos[i]->partition.count();
+        population.max_sub_size = pop_infos[i]->partition.max_size;
+        population.sub_projections = 0;
+        population.sub_synapses = 0;
+        population.sub_inputs = 0;
+        population.connections = 0;
+        population.hash_rows = 0;
+        population.bound = false;
+        population_indices[population.name] = populations.size();
+        populations.append(population);
+    }
+
+    //synapses and inputs
+    for (int i=0; i<components.size(); i++){
+        if (components[i]->Type() == COMPONENT_TYPE_WEIGHT_UPDATE)
+            planSynapse((WeightUpdateInfo*)components[i]);
+    }
+    const QList<InputInfo> &input_infos = info->getInputInfo();
+    for (int i=0; i<input_infos.size(); i++)
+        planInput(input_infos[i]);
+
+    //a sub population has at most one sub projection to each target sub population (shared by its sub synapses)
+    for (QHash<QString, QHash<QString, quint64> >::const_iterator p = projection_sub_synapses.constBegin(); p != projection_sub_synapses.constEnd(); ++p){
+        PopulationPlan *population = populationPlan(p.key());
+        if (population == NULL)
+            continue;
+        for (QHash<QString, quint64>::const_iterator t = p.value().constBegin(); t != p.value().constEnd(); ++t){
+            quint64 pairs = (quint64)population->sub_populations * info->getPartition(t.key()).count();
+            population->sub_projections += qMin(pairs, t.value());
+        }
+    }
+
+    //sources of the same population share hash table rows
+    for (QHash<QString, QHash<QString, uint> >::const_iterator d = hash_rows.constBegin(); d != hash_rows.constEnd(); ++d){
+        PopulationPlan *population = populationPlan(d.key());
+        if (population == NULL)
+            continue;
+        for (QHash<QString, uint>::const_iterator s = d.value().constBegin(); s != d.value().constEnd(); ++s)
+            population->hash_rows += s.value();
+    }
+}
+
+void SplitPlanner::planSynapse(WeightUpdateInfo *wu_info)
+{
+    bool defined_at_src = (info->getSplitterMode() != SPLITMODE_PROJ_DEF_AT_DST);
+    PopulationPartition partition = info->getPartition(wu_info->population);
+    PopulationPartition target_partition = info->getPartition(wu_info->projPopulation);
+    quint64 sub_pop_pairs = (quint64)partition.count() * target_partition.count();
+
+    ConnectionPlan synapse;
+    synapse.name = wu_info->name;
+    synapse.src = defined_at_src ? wu_info->population : wu_info->projPopulation;
+    synapse.dst = defined_at_src ? wu_info->projPopulation : wu_info->population;
+    synapse.population = wu_info->population;
+    synapse.connectivity = wu_info->connectivity;
+    synapse.connections = (wu_info->connectivity == LIST_CONNECTVITY_TYPE) ? wu_info->connectionListCount : 0;
+    synapse.bound = (wu_info->connectivity == LIST_CONNECTVITY_TYPE);
+    switch(wu_info->connectivity){
+        case(ALL_TO_ALL_CONNECTVITY_TYPE):
+        case(FIXED_PROBABILITY_CONNECTVITY_TYPE):{
+            //a sub synapse to every target sub population
+            synapse.sub_max = target_partition.count();
+            synapse.sub_connections = sub_pop_pairs;
+            break;
+        }
+        case(ONE_TO_ONE_CONNECTVITY_TYPE):{
+            synapse.sub_max = 1;
+            synapse.sub_connections = partition.count();
+            break;
+        }
+        case(LIST_CONNECTVITY_TYPE):{
+            //a sub synapse to each target sub population with a connection
+            synapse.sub_max = qMin((quint64)target_partition.count(), synapse.connections);
+            synapse.sub_connections = qMin(sub_pop_pairs, synapse.connections);
+            break;
+        }
+        default:{
+            synapse.sub_max = 0;
+            synapse.sub_connections = 0;
+            break;
+        }
+    }
+    synapses.append(synapse);
+
+    PopulationPlan *population = populationPlan(wu_info->population);
+    if (population != NULL){
+        population->sub_synapses += synapse.sub_connections;
+        population->connections += synapse.connections;
+        population->bound |= synapse.bound;
+    }
+    projection_sub_synapses[wu_info->population][wu_info->projPopulation] += synapse.sub_connections;
+
+    //src sub populations of each dst sub population
+    uint src_sub_count = info->getPartition(synapse.src).count();
+    addHashRows(synapse.dst, synapse.src, subSourcesPerTarget(synapse.connectivity, src_sub_count, synapse.connections), synapse.bound);
+}
+
+void SplitPlanner::planInput(const InputInfo &input_info)
+{
+    PopulationPartition partition = info->getPartition(input_info.dst_population);
+    PopulationPartition src_partition = info->getPartition(input_info.src);
+
+    ConnectionPlan input;
+    input.name = input_info.src + " -> " + input_info.dst_population;
+    input.src = input_info.src;
+    input.dst = input_info.dst_population;
+    input.population = input_info.dst_population;
+    input.connectivity = input_info.connectivity;
+    input.connections = (input_info.connectivity == LIST_CONNECTVITY_TYPE) ? input_info.connectionListCount : 0;
+    input.bound = (input_info.connectivity == LIST_CONNECTVITY_TYPE);
+    input.sub_max = subSourcesPerTarget(input.connectivity, src_partition.count(), input.connections);
+    if (input.connectivity == LIST_CONNECTVITY_TYPE)
+        input.sub_connections = qMin((quint64)partition.count() * src_partition.count(), input.connections);
+    else
+        input.sub_connections = (quint64)partition.count() * input.sub_max;
+    inputs.append(input);
+
+    PopulationPlan *population = populationPlan(input_info.dst_population);
+    if (population != NULL){
+        population->sub_inputs += input.sub_connections;
+        population->connections += input.connections;
+        population->bound |= input.bound;
+    }
+    addHashRows(input.dst, input.src, input.sub_max, input.bound);
+}
+
+uint SplitPlanner::subSourcesPerTarget(ConnectivityType connectivity, uint src_sub_count, quint64 connections)
+{
+    switch(connectivity){
+        case(ALL_TO_ALL_CONNECTVITY_TYPE):
+        case(FIXED_PROBABILITY_CONNECTVITY_TYPE):
+            return src_sub_count;
+        case(ONE_TO_ONE_CONNECTVITY_TYPE):
+            return 1;
+        case(LIST_CONNECTVITY_TYPE):
+            return (uint)qMin((quint64)src_sub_count, connections);
+        default:
+            return 0;
+    }
+}
+
+void SplitPlanner::addHashRows(QString dst_population, QString src, uint rows, bool bound)
+{
+    QHash<QString, uint> &dst_rows = hash_rows[dst_population];
+    if (rows > dst_rows.value(src, 0))
+        dst_rows[src] = rows;
+    PopulationPlan *population = populationPlan(dst_population);
+    if (population != NULL)
+        population->bound |= bound;
+}
+
+PopulationPlan *SplitPlanner::populationPlan(QString name)
+{
+    if (!population_indices.contains(name))
+        return NULL;
+    return &populations[population_indices[name]];
+}
+
+void SplitPlanner::report()
+{
+    quint64 sub_populations = 0;
+    quint64 sub_projections = 0;
+    quint64 sub_synapses = 0;
+    quint64 sub_inputs = 0;
+    quint64 connections = 0;
+    quint64 peak_connections = 0;
+    QString peak_population;
+    QStringList warnings;
+    bool bound = false;
+
+    std::cout << "Split plan (counts marked <= are upper bounds from connection list sizes)" << std::endl << std::endl;
+
+    //populations
+    std::cout << QString("%1 %2 %3 %4 %5 %6 %7 %8").arg("Population", -32).arg("Size", 10).arg("Subs", 8).arg("SubSize", 8).arg("SubProjs", 12).arg("SubSyns", 12).arg("SubInps", 12).arg("HashRows", 10).toLocal8Bit().data() << std::endl;
+    for (int i=0; i<populations.size(); i++){
+        const PopulationPlan &population = populations[i];
+        std::cout << QString("%1 %2 %3 %4 %5 %6 %7 %8").arg(population.name, -32).arg(population.size, 10).arg(population.sub_populations, 8).arg(population.max_sub_size, 8)
+                     .arg(formatCount(population.sub_projections, population.bound), 12).arg(formatCount(population.sub_synapses, population.bound), 12)
+                     .arg(formatCount(population.sub_inputs, population.bound), 12).arg(formatCount(population.hash_rows, population.bound), 10).toLocal8Bit().data() << std::endl;
+        sub_populations += population.sub_populations;
+        sub_projections += population.sub_projections;
+        sub_synapses += population.sub_synapses;
+        sub_inputs += population.sub_inputs;
+        connections += population.connections;
+        bound |= population.bound;
+        if (population.connections >= peak_connections){
+            peak_connections = population.connections;
+            peak_population = population.name;
+        }
+        if (population.hash_rows > MAX_PROJ_INPUTS)
+            warnings.append(QString("Warning: sub populations of '%1' may need %2 DAMSON hash table rows (maximum %3)").arg(population.name).arg(population.hash_rows).arg(MAX_PROJ_INPUTS));
+    }
+    std::cout << std::endl;
+
+    //synapses and inputs
+    QList<ConnectionPlan> *plans[2] = {&synapses, &inputs};
+    QString titles[2] = {"Synapse", "Input"};
+    for (int l=0; l<2; l++){
+        std::cout << QString("%1 %2 %3 %4 %5").arg(titles[l], -40).arg("Connectivity", -16).arg("Connections", 12).arg("SubCount", 12).arg("SubMax", 10).toLocal8Bit().data() << std::endl;
+        for (int i=0; i<plans[l]->size(); i++){
+            const ConnectionPlan &plan = plans[l]->at(i);
+            std::cout << QString("%1 %2 %3 %4 %5").arg(plan.name, -40).arg(connectivityName(plan.connectivity), -16).arg(plan.connections, 12)
+                         .arg(formatCount(plan.sub_connections, plan.bound), 12).arg(formatCount(plan.sub_max, plan.bound), 10).toLocal8Bit().data() << std::endl;
+        }
+        std::cout << std::endl;
+    }
+
+    //totals and estimates
+    quint64 output_bytes = sub_populations*PLAN_XML_SUB_POPULATION_BYTES + sub_projections*PLAN_XML_SUB_PROJECTION_BYTES + sub_synapses*PLAN_XML_SUB_SYNAPSE_BYTES
+                         + sub_inputs*PLAN_XML_SUB_INPUT_BYTES + connections*PLAN_XML_CONNECTION_BYTES;
+    quint64 peak_bytes = peak_connections*(PLAN_PARSED_CONNECTION_BYTES + PLAN_SPLIT_CONNECTION_BYTES);
+    std::cout << populations.size() << " Populations, " << sub_populations << " Sub Populations" << std::endl;
+    std::cout << synapses.size() << " Synapses, " << formatCount(sub_projections, bound).toLocal8Bit().data() << " Sub Projections, " << formatCount(sub_synapses, bound).toLocal8Bit().data() << " Sub Synapses" << std::endl;
+    std::cout << inputs.size() << " Inputs, " << formatCount(sub_inputs, bound).toLocal8Bit().data() << " Sub Inputs" << std::endl;
+    std::cout << connections << " Explicit Connections" << std::endl;
+    std::cout << "Estimated xml output size: " << formatBytes(output_bytes).toLocal8Bit().data() << " (excluding properties)" << std::endl;
+    if (!peak_population.isEmpty())
+        std::cout << "Estimated peak memory per population: " << formatBytes(peak_bytes).toLocal8Bit().data() << " ('" << peak_population.toLocal8Bit().data() << "' parsed and split)" << std::endl;
+    for (int i=0; i<warnings.size(); i++)
+        std::cout << warnings[i].toLocal8Bit().data() << std::endl;
+}
+
+QString SplitPlanner::connectivityName(ConnectivityType connectivity)
+{
+    switch(connectivity){
+        case(ALL_TO_ALL_CONNECTVITY_TYPE):
+            return "AllToAll";
+        case(ONE_TO_ONE_CONNECTVITY_TYPE):
+            return "OneToOne";
+        case(LIST_CONNECTVITY_TYPE):
+            return "List";
+        case(FIXED_PROBABILITY_CONNECTVITY_TYPE):
+            return "FixedProbability";
+        default:
+            return "None";
+    }
+}
+
+QString SplitPlanner::formatCount(quint64 count, bool bound)
+{
+    if (bound)
+        return "<=" + QString::number(count);
+    return QString::number(count);
+}
+
+QString SplitPlanner::formatBytes(quint64 bytes)
+{
+    if (bytes >= Q_UINT64_C(1073741824))
+        return QString::number(bytes/1073741824.0, 'f', 1) + " GB";
+    if (bytes >= Q_UINT64_C(1048576))
+        return QString::number(bytes/1048576.0, 'f', 1) + " MB";
+    return QString::number(bytes/1024.0, 'f', 1) + " KB";
+}
@@ -0,0 +1,80 @@
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include "modelobjects.h"
+#include "infoparser.h"
+
+//estimated size of the xml output of each split object (properties are not known to the info parse)
+#define PLAN_XML_SUB_POPULATION_BYTES 300
+#define PLAN_XML_SUB_PROJECTION_BYTES 100
+#define PLAN_XML_SUB_SYNAPSE_BYTES 500
+#define PLAN_XML_SUB_INPUT_BYTES 150
+#define PLAN_XML_CONNECTION_BYTES 100
+//estimated memory of an explicit connection once parsed (row, col, delay, index and buckets) and once split
+#define PLAN_PARSED_CONNECTION_BYTES 32
+#define PLAN_SPLIT_CONNECTION_BYTES 32
+
+//planned split of the synapses or inputs of one unsplit synapse or input. Only the connection count of lists is known
+//to the info parse so list counts are upper bounds.
+class ConnectionPlan
+{
+public:
+    QString name;
+    QString src;
+    QString dst;
+    QString population;             //population the synapse or input is defined in
+    ConnectivityType connectivity;
+    quint64 connections;            //explicit connections (lists only)
+    quint64 sub_connections;        //sub synapses or sub inputs
+    uint sub_max;                   //maximum per sub component (_sub_syn_max or sub_inp_max)
+    bool bound;                     //counts are upper bounds
+};
+
+class PopulationPlan
+{
+public:
+    QString name;
+    uint size;
+    uint sub_populations;
+    uint max_sub_size;
+    quint64 sub_projections;
+    quint64 sub_synapses;
+    quint64 sub_inputs;
+    quint64 connections;            //explicit connections defined in the population
+    uint hash_rows;                 //src sub populations of a sub population (DAMSON input hash table rows)
+    bool bound;
+};
+
+//reports how a model will split from the info parse alone (no population is fully parsed, split or written)
+class SplitPlanner
+{
+public:
+    SplitPlanner(InfoParser *info);
+
+    void plan();
+    void report();      //writes the plan to the console
+
+private:
+    void planSynapse(WeightUpdateInfo *wu_info);
+    void planInput(const InputInfo &input_info);
+    uint subSourcesPerTarget(ConnectivityType connectivity, uint src_sub_count, quint64 connections);
+    void addHashRows(QString dst_population, QString src, uint rows, bool bound);
+    PopulationPlan *populationPlan(QString name);   //NULL if not a population
+    QString connectivityName(ConnectivityType connectivity);
+    QString formatCount(quint64 count, bool bound);
+    QString formatBytes(quint64 bytes);
+
+private:
+    InfoParser *info;
+    QList<PopulationPlan> populations;              //document order
+    QHash<QString, int> population_indices;
+    QList<ConnectionPlan> synapses;
+    QList<ConnectionPlan> inputs;
+    QHash<QString, QHash<QString, uint> > hash_rows;    //rows of each src by dst population
+    QHash<QString, QHash<QString, quint64> > projection_sub_synapses;  //summed sub synapses by population and proj_population
+};
+
+#endif // PLANNER_H
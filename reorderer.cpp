@@ -0,0 +1,589 @@
+#include "reorderer.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QDebug>
+#include <iostream>
+#include <algorithm>
+#include <queue>
+#include <omp.h>
+
+
+Reorderer::Reorderer(InfoParser *info)
+{
+    this->info = info;
+}
+
+void Reorderer::addPopulation(Population *population)
+{
+    QString pop_name = population->neuron->name;
+    population_names.append(pop_name);
+    component_populations[pop_name] = pop_name;
+    addInputs(population->neuron, pop_name);
+
+    //rows of projection lists are the neurons of the population the projection is defined in
+    bool defined_at_dst = (info->getSplitterMode() == SPLITMODE_PROJ_DEF_AT_DST);
+    for (QHash<QString, Projection*>::const_iterator p = population->projections.constBegin(); p != population->projections.constEnd(); ++p){
+        Projection *projection = p.value();
+        QString src_name = defined_at_dst ? projection->proj_population : pop_name;
+        QString dst_name = defined_at_dst ? pop_name : projection->proj_population;
+
+        for (QHash<QString, Synapse*>::const_iterator s = projection->synapses.constBegin(); s != projection->synapses.constEnd(); ++s){
+            Synapse *synapse = s.value();
+            ReorderLink link;
+            link.connection = synapse->connection;
+            link.row_component = pop_name;
+            link.col_component = projection->proj_population;
+            links.append(link);
+            if (synapse->connection->Type() == ALL_TO_ALL_CONNECTVITY_TYPE)
+                all_to_all_weight_updates[synapse->weightupdate->name] = qMakePair(src_name, dst_name);
+
+            //postsynapses are indexed by dst neuron
+            component_populations[synapse->postsynapse->name] = dst_name;
+            addInputs(synapse->postsynapse, synapse->postsynapse->name);
+
+            //weight update inputs are indexed by connection so neither population is reordered
+            if (!synapse->weightupdate->inputs.isEmpty()){
+                ReorderLink pin;
+                pin.connection = NULL;
+                pin.row_component = src_name;
+                pin.col_component = dst_name;
+                links.append(pin);
+                addInputs(synapse->weightupdate, synapse->weightupdate->name);
+            }
+        }
+    }
+}
+
+void Reorderer::addInputs(Component *component, QString component_name)
+{
+    //rows of input remappings are the component (dst) neurons
+    for (QHash<QString, Input*>::const_iterator i = component->inputs.constBegin(); i != component->inputs.constEnd(); ++i){
+        ReorderLink link;
+        link.connection = i.value()->remapping;
+        link.row_component = component_name;
+        link.col_component = i.value()->src;
+        links.append(link);
+    }
+}
+
+QString Reorderer::populationOf(QString component_name)
+{
+    return component_populations.value(component_name);
+}
+
+const QVector<uint> &Reorderer::permutationOf(QString component_name)
+{
+    QHash<QString, QVector<uint> >::const_iterator permutation = permutations.constFind(populationOf(component_name));
+    if (permutation == permutations.constEnd())
+        return identity;
+    return permutation.value();
+}
+
+void Reorderer::reorder()
+{
+    //populations sharing an index space with another population (or a weight update) keep their numbering
+    QSet<QString> pinned;
+    QSet<QString> listed;
+    for (int l=0; l<links.size(); l++){
+        const ReorderLink &link = links[l];
+        QString row_population = populationOf(link.row_component);
+        QString col_population = populationOf(link.col_component);
+        if ((link.connection == NULL) || (link.connection->Type() == ONE_TO_ONE_CONNECTVITY_TYPE) || row_population.isEmpty() || col_population.isEmpty()){
+            if (!row_population.isEmpty())
+                pinned.insert(row_population);
+            if (!col_population.isEmpty())
+                pinned.insert(col_population);
+        }else if (link.connection->Type() == LIST_CONNECTVITY_TYPE){
+            listed.insert(row_population);
+            listed.insert(col_population);
+        }
+    }
+
+    //only populations with list connectivity have structure to cluster
+    QStringList reordered;
+    for (int i=0; i<population_names.size(); i++){
+        if (listed.contains(population_names[i]) && !pinned.contains(population_names[i]))
+            reordered.append(population_names[i]);
+    }
+    if (reordered.isEmpty())
+        return;
+
+    QHash<QString, uint> global_offsets;
+    ReorderGraph graph = buildGraph(reordered, global_offsets);
+
+    //order vertices by recursive bisection so that clusters of connected neurons are contiguous
+    QVector<uint> vertices(graph.size());
+    for (uint v=0; v<graph.size(); v++)
+        vertices[v] = v;
+    QVector<uint> order;
+    order.reserve(graph.size());
+    local_index.fill(-1, graph.size());
+    orderVertices(graph, vertices, order);
+    local_index.clear();
+
+    //the order of the neurons of each population within the global order is its permutation
+    QVector<uint> starts(reordered.size()+1);
+    for (int p=0; p<reordered.size(); p++){
+        starts[p] = global_offsets[reordered[p]];
+        permutations[reordered[p]] = QVector<uint>(info->getComponentInfo(reordered[p])->size);
+    }
+    starts[reordered.size()] = graph.size();
+    QVector<uint> next_index(reordered.size(), 0);
+    for (int k=0; k<order.size(); k++){
+        uint v = order[k];
+        int p = std::upper_bound(starts.constBegin(), starts.constEnd(), v) - starts.constBegin() - 1;
+        permutations[reordered[p]][v - starts[p]] = next_index[p]++;
+    }
+
+    //identity permutations need not be applied
+    for (int p=0; p<reordered.size(); p++){
+        const QVector<uint> &permutation = permutations[reordered[p]];
+        bool is_identity = true;
+        for (int n=0; n<permutation.size() && is_identity; n++)
+            is_identity = (permutation[n] == (uint)n);
+        if (is_identity)
+            permutations.remove(reordered[p]);
+    }
+}
+
+ReorderGraph Reorderer::buildGraph(const QStringList &reordered, QHash<QString, uint> &global_offsets)
+{
+    ReorderGraph graph;
+    uint n = 0;
+    for (int p=0; p<reordered.size(); p++){
+        global_offsets[reordered[p]] = n;
+        n += info->getComponentInfo(reordered[p])->size;
+    }
+
+    //count then fill both directions of each list connection between reordered populations
+    QVector<uint> offsets(n+1, 0);
+    QVector<uint> adjacency;
+    for (int pass=0; pass<2; pass++){
+        QVector<uint> next = offsets;
+        for (int l=0; l<links.size(); l++){
+            const ReorderLink &link = links[l];
+            if ((link.connection == NULL) || (link.connection->Type() != LIST_CONNECTVITY_TYPE))
+                continue;
+            QString row_population = populationOf(link.row_component);
+            QString col_population = populationOf(link.col_component);
+            if (!global_offsets.contains(row_population) || !global_offsets.contains(col_population))
+                continue;
+            ConnectionList *connection_list = (ConnectionList*)link.connection;
+            uint row_offset = global_offsets[row_population];
+            uint col_offset = global_offsets[col_population];
+            uint rows = qMin(connection_list->rowCount(), info->getComponentInfo(row_population)->size);
+            uint col_size = info->getComponentInfo(col_population)->size;
+            for (uint r=0; r<rows; r++){
+                for (uint c=connection_list->rowStart(r); c<connection_list->rowEnd(r); c++){
+                    if (connection_list->cols[c] >= col_size)
+                        continue;   //reported by the splitter
+                    uint u = row_offset + r;
+                    uint v = col_offset + connection_list->cols[c];
+                    if (u == v)
+                        continue;
+                    if (pass == 0){
+                        offsets[u+1]++;
+                        offsets[v+1]++;
+                    }else{
+                        adjacency[next[u]++] = v;
+                        adjacency[next[v]++] = u;
+                    }
+                }
+            }
+        }
+        if (pass == 0){
+            for (uint v=0; v<n; v++)
+                offsets[v+1] += offsets[v];
+            adjacency.resize(offsets[n]);
+        }
+    }
+
+    //merge parallel edges into weighted edges
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int v=0; v<(int)n; v++)
+        std::sort(adjacency.begin()+offsets[v], adjacency.begin()+offsets[v+1]);
+    graph.offsets.reserve(n+1);
+    graph.offsets.append(0);
+    for (uint v=0; v<n; v++){
+        for (uint e=offsets[v]; e<offsets[v+1]; e++){
+            if ((e > offsets[v]) && (adjacency[e] == adjacency[e-1]))
+                graph.edge_weights.last()++;
+            else{
+                graph.adjacency.append(adjacency[e]);
+                graph.edge_weights.append(1);
+            }
+        }
+        graph.offsets.append(graph.adjacency.size());
+    }
+    graph.vertex_weights.fill(1, n);
+    return graph;
+}
+
+void Reorderer::orderVertices(const ReorderGraph &graph, const QVector<uint> &vertices, QVector<uint> &order)
+{
+    if (vertices.size() <= REORDER_LEAF_SIZE){
+        order += vertices;
+        return;
+    }
+
+    QVector<uint> side = bisect(inducedGraph(graph, vertices));
+    QVector<uint> first;
+    QVector<uint> second;
+    for (int i=0; i<vertices.size(); i++){
+        if (side[i] == 0)
+            first.append(vertices[i]);
+        else
+            second.append(vertices[i]);
+    }
+    side.clear();
+    if (first.isEmpty() || second.isEmpty()){
+        order += vertices;  //no bisection within the balance constraint
+        return;
+    }
+    orderVertices(graph, first, order);
+    orderVertices(graph, second, order);
+}
+
+ReorderGraph Reorderer::inducedGraph(const ReorderGraph &graph, const QVector<uint> &vertices)
+{
+    ReorderGraph induced;
+    for (int i=0; i<vertices.size(); i++)
+        local_index[vertices[i]] = i;
+
+    induced.offsets.reserve(vertices.size()+1);
+    induced.offsets.append(0);
+    induced.vertex_weights.resize(vertices.size());
+    for (int i=0; i<vertices.size(); i++){
+        uint v = vertices[i];
+        for (uint e=graph.offsets[v]; e<graph.offsets[v+1]; e++){
+            int u = local_index[graph.adjacency[e]];
+            if (u < 0)
+                continue;
+            induced.adjacency.append(u);
+            induced.edge_weights.append(graph.edge_weights[e]);
+        }
+        induced.offsets.append(induced.adjacency.size());
+        induced.vertex_weights[i] = graph.vertex_weights[v];
+    }
+
+    for (int i=0; i<vertices.size(); i++)
+        local_index[vertices[i]] = -1;
+    return induced;
+}
+
+QVector<uint> Reorderer::bisect(const ReorderGraph &graph)
+{
+    //multilevel: coarsen by heavy edge matching, bisect the coarsest graph then project back refining each level
+    QList<ReorderGraph> levels;
+    QList<QVector<uint> > coarse_maps;
+    levels.append(graph);
+    while (levels.last().size() > REORDER_COARSEST_SIZE){
+        QVector<uint> coarse_map;
+        ReorderGraph coarse = coarsen(levels.last(), coarse_map);
+        if (coarse.size() > levels.last().size()*REORDER_COARSEN_MIN_REDUCTION)
+            break;
+        levels.append(coarse);
+        coarse_maps.append(coarse_map);
+    }
+
+    QVector<uint> side = initialBisection(levels.last());
+    refine(levels.last(), side);
+    for (int l=levels.size()-2; l>=0; l--){
+        QVector<uint> fine_side(levels[l].size());
+        for (uint v=0; v<levels[l].size(); v++)
+            fine_side[v] = side[coarse_maps[l][v]];
+        side.swap(fine_side);
+        levels.removeLast();
+        refine(levels[l], side);
+    }
+    return side;
+}
+
+ReorderGraph Reorderer::coarsen(const ReorderGraph &graph, QVector<uint> &coarse_map)
+{
+    uint n = graph.size();
+    QVector<int> match(n, -1);
+    QVector<uint> members;      //pairs of fine vertices of each coarse vertex
+    coarse_map.resize(n);
+    uint coarse_n = 0;
+    for (uint v=0; v<n; v++){
+        if (match[v] >= 0)
+            continue;
+        //match with the unmatched neighbour of the heaviest edge
+        int best = -1;
+        uint best_weight = 0;
+        for (uint e=graph.offsets[v]; e<graph.offsets[v+1]; e++){
+            uint u = graph.adjacency[e];
+            if ((u != v) && (match[u] < 0) && (graph.edge_weights[e] > best_weight)){
+                best = u;
+                best_weight = graph.edge_weights[e];
+            }
+        }
+        match[v] = (best >= 0) ? best : v;
+        coarse_map[v] = coarse_n;
+        if (best >= 0){
+            match[best] = v;
+            coarse_map[best] = coarse_n;
+        }
+        members.append(v);
+        members.append(match[v]);
+        coarse_n++;
+    }
+
+    ReorderGraph coarse;
+    coarse.vertex_weights.fill(0, coarse_n);
+    for (uint v=0; v<n; v++)
+        coarse.vertex_weights[coarse_map[v]] += graph.vertex_weights[v];
+
+    //edges between coarse vertices (edges within a coarse vertex are removed)
+    QVector<int> slot(coarse_n, -1);
+    coarse.offsets.reserve(coarse_n+1);
+    coarse.offsets.append(0);
+    for (uint c=0; c<coarse_n; c++){
+        uint start = coarse.adjacency.size();
+        for (uint m=0; m<2; m++){
+            uint v = members[2*c+m];
+            if ((m == 1) && (v == members[2*c]))
+                break;
+            for (uint e=graph.offsets[v]; e<graph.offsets[v+1]; e++){
+                uint u = coarse_map[graph.adjacency[e]];
+                if (u == c)
+                    continue;
+                if (slot[u] < 0){
+                    slot[u] = coarse.adjacency.size();
+                    coarse.adjacency.append(u);
+                    coarse.edge_weights.append(graph.edge_weights[e]);
+                }else
+                    coarse.edge_weights[slot[u]] += graph.edge_weights[e];
+            }
+        }
+        for (uint e=start; e<(uint)coarse.adjacency.size(); e++)
+            slot[coarse.adjacency[e]] = -1;
+        coarse.offsets.append(coarse.adjacency.size());
+    }
+    return coarse;
+}
+
+QVector<uint> Reorderer::initialBisection(const ReorderGraph &graph)
+{
+    //grow the first half from the lowest vertex adding the vertex most connected to it (graph growing)
+    uint n = graph.size();
+    qint64 total = 0;
+    for (uint v=0; v<n; v++)
+        total += graph.vertex_weights[v];
+
+    QVector<uint> side(n, 1);
+    QVector<qint64> connection(n, 0);
+    std::priority_queue<std::pair<qint64, uint> > queue;
+    qint64 grown = 0;
+    uint next_seed = 0;
+    while (2*grown < total){
+        if (queue.empty()){
+            while ((next_seed < n) && (side[next_seed] == 0))
+                next_seed++;
+            if (next_seed == n)
+                break;
+            queue.push(std::make_pair((qint64)0, next_seed));
+        }
+        uint v = queue.top().second;
+        qint64 gain = queue.top().first;
+        queue.pop();
+        if ((side[v] == 0) || (gain != connection[v]))
+            continue;
+        side[v] = 0;
+        grown += graph.vertex_weights[v];
+        for (uint e=graph.offsets[v]; e<graph.offsets[v+1]; e++){
+            uint u = graph.adjacency[e];
+            if (side[u] == 1){
+                connection[u] += graph.edge_weights[e];
+                queue.push(std::make_pair(connection[u], u));
+            }
+        }
+    }
+    return side;
+}
+
+void Reorderer::refine(const ReorderGraph &graph, QVector<uint> &side)
+{
+    //Kernighan-Lin (Fiduccia-Mattheyses) passes: move the highest gain vertex within the balance constraint, lock it and
+    //keep the best prefix of moves
+    uint n = graph.size();
+    qint64 total = 0;
+    qint64 max_vertex = 0;
+    qint64 part_weight[2] = {0, 0};
+    for (uint v=0; v<n; v++){
+        total += graph.vertex_weights[v];
+        max_vertex = qMax(max_vertex, (qint64)graph.vertex_weights[v]);
+        part_weight[side[v]] += graph.vertex_weights[v];
+    }
+    qint64 max_part = total/2 + qMax((qint64)(REORDER_IMBALANCE*total), max_vertex);
+
+    QVector<qint64> gain(n);
+    QVector<bool> locked(n);
+    for (int pass=0; pass<REORDER_REFINE_PASSES; pass++){
+        std::priority_queue<std::pair<qint64, uint> > queue;
+        for (uint v=0; v<n; v++){
+            gain[v] = 0;
+            for (uint e=graph.offsets[v]; e<graph.offsets[v+1]; e++)
+                gain[v] += (side[graph.adjacency[e]] != side[v]) ? graph.edge_weights[e] : -(qint64)graph.edge_weights[e];
+            locked[v] = false;
+            if (graph.offsets[v+1] > graph.offsets[v])
+                queue.push(std::make_pair(gain[v], v));
+        }
+
+        QVector<uint> moves;
+        qint64 cut_change = 0;
+        qint64 best_change = 0;
+        int best_moves = 0;
+        while (!queue.empty() && (moves.size() - best_moves < REORDER_REFINE_MAX_BAD_MOVES)){
+            uint v = queue.top().second;
+            qint64 g = queue.top().first;
+            queue.pop();
+            if (locked[v] || (g != gain[v]))
+                continue;
+            uint to = 1 - side[v];
+            if (part_weight[to] + graph.vertex_weights[v] > max_part)
+                continue;
+
+            side[v] = to;
+            part_weight[to] += graph.vertex_weights[v];
+            part_weight[1-to] -= graph.vertex_weights[v];
+            locked[v] = true;
+            moves.append(v);
+            cut_change -= g;
+            if (cut_change < best_change){
+                best_change = cut_change;
+                best_moves = moves.size();
+            }
+            for (uint e=graph.offsets[v]; e<graph.offsets[v+1]; e++){
+                uint u = graph.adjacency[e];
+                if (locked[u])
+                    continue;
+                gain[u] += (side[u] == to) ? -2*(qint64)graph.edge_weights[e] : 2*(qint64)graph.edge_weights[e];
+                queue.push(std::make_pair(gain[u], u));
+            }
+        }
+
+        //undo the moves after the best cut
+        for (int m=moves.size()-1; m>=best_moves; m--){
+            uint v = moves[m];
+            uint from = side[v];
+            side[v] = 1 - from;
+            part_weight[from] -= graph.vertex_weights[v];
+            part_weight[1-from] += graph.vertex_weights[v];
+        }
+        if (best_change == 0)
+            break;
+    }
+}
+
+void Reorderer::remapPopulation(Population *population)
+{
+    QString pop_name = population->neuron->name;
+    const QVector<uint> &permutation = permutationOf(pop_name);
+    for (int i=0; i<population->neuron->properties.size(); i++){
+        if (population->neuron->properties[i]->value->Type() == VALUE_LIST_TYPE)
+            ((PropertyValueList*)population->neuron->properties[i]->value)->permute(permutation, identity, 1);
+    }
+    remapInputs(population->neuron, pop_name);
+
+    bool defined_at_dst = (info->getSplitterMode() == SPLITMODE_PROJ_DEF_AT_DST);
+    for (QHash<QString, Projection*>::const_iterator p = population->projections.constBegin(); p != population->projections.constEnd(); ++p){
+        Projection *projection = p.value();
+        QString src_name = defined_at_dst ? projection->proj_population : pop_name;
+        QString dst_name = defined_at_dst ? pop_name : projection->proj_population;
+
+        for (QHash<QString, Synapse*>::const_iterator s = projection->synapses.constBegin(); s != projection->synapses.constEnd(); ++s){
+            Synapse *synapse = s.value();
+            //list weight update properties are indexed by connection index which is kept
+            if (synapse->connection->Type() == LIST_CONNECTVITY_TYPE)
+                ((ConnectionList*)synapse->connection)->permute(permutation, permutationOf(projection->proj_population));
+            if (synapse->connection->Type() == ALL_TO_ALL_CONNECTVITY_TYPE){
+                uint dst_size = info->getComponentInfo(dst_name)->size;
+                for (int i=0; i<synapse->weightupdate->properties.size(); i++){
+                    if (synapse->weightupdate->properties[i]->value->Type() == VALUE_LIST_TYPE)
+                        ((PropertyValueList*)synapse->weightupdate->properties[i]->value)->permute(permutationOf(src_name), permutationOf(dst_name), dst_size);
+                }
+            }
+            for (int i=0; i<synapse->postsynapse->properties.size(); i++){
+                if (synapse->postsynapse->properties[i]->value->Type() == VALUE_LIST_TYPE)
+                    ((PropertyValueList*)synapse->postsynapse->properties[i]->value)->permute(permutationOf(dst_name), identity, 1);
+            }
+            remapInputs(synapse->postsynapse, dst_name);
+        }
+    }
+}
+
+void Reorderer::remapInputs(Component *component, QString component_name)
+{
+    for (QHash<QString, Input*>::const_iterator i = component->inputs.constBegin(); i != component->inputs.constEnd(); ++i){
+        Input *input = i.value();
+        if (input->remapping->Type() == LIST_CONNECTVITY_TYPE)
+            ((ConnectionList*)input->remapping)->permute(permutationOf(component_name), permutationOf(input->src));
+    }
+}
+
+void Reorderer::remapLogOutputs(Experiment *experiment)
+{
+    if (experiment == NULL)
+        return;
+    for (QHash<QString, LogOutput*>::iterator o = experiment->outputs.begin(); o != experiment->outputs.end(); ++o){
+        LogOutput *output = o.value();
+        if (output->indices.isEmpty())
+            continue;
+
+        //all to all weight updates are indexed by src*dst_size+dst
+        const QVector<uint> *row_permutation = &permutationOf(output->target);
+        const QVector<uint> *col_permutation = &identity;
+        uint col_count = 1;
+        if (all_to_all_weight_updates.contains(output->target)){
+            QPair<QString, QString> populations = all_to_all_weight_updates[output->target];
+            row_permutation = &permutationOf(populations.first);
+            col_permutation = &permutationOf(populations.second);
+            col_count = info->getComponentInfo(populations.second)->size;
+        }
+        if (row_permutation->isEmpty() && col_permutation->isEmpty())
+            continue;
+
+        QSet<int> indices;
+        for (QSet<int>::const_iterator i = output->indices.constBegin(); i != output->indices.constEnd(); ++i){
+            if (*i < 0){
+                indices.insert(*i);
+                continue;
+            }
+            uint row = *i / col_count;
+            uint col = *i % col_count;
+            row = (row < (uint)row_permutation->size()) ? (*row_permutation)[row] : row;
+            col = (col < (uint)col_permutation->size()) ? (*col_permutation)[col] : col;
+            indices.insert(row*col_count + col);
+        }
+        output->indices = indices;
+    }
+}
+
+void Reorderer::writePermutations(QString filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)){
+        std::cerr << "Error opening permutation output file: " << filename.toLocal8Bit().data() << std::endl;
+        exit(0);
+    }
+    QTextStream out(&file);
+    out << "#population_name new_index_of_neuron_0 new_index_of_neuron_1 ..." << "\n";
+    for (int p=0; p<population_names.size(); p++){
+        if (!permutations.contains(population_names[p]))
+            continue;
+        const QVector<uint> &permutation = permutations[population_names[p]];
+        out << population_names[p];
+        for (int n=0; n<permutation.size(); n++)
+            out << " " << permutation[n];
+        out << "\n";
+    }
+    file.close();
+}
+
+uint Reorderer::getReorderedCount()
+{
+    return permutations.size();
+}
@@ -0,0 +1,82 @@
+#ifndef REORDERER_H
+#define REORDERER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include "modelobjects.h"
+#include "infoparser.h"
+
+#define REORDER_COARSEST_SIZE 64            //graphs are coarsened until no larger than this
+#define REORDER_COARSEN_MIN_REDUCTION 0.9   //coarsening stops when a level removes fewer vertices than this
+#define REORDER_REFINE_PASSES 4             //Kernighan-Lin passes per level
+#define REORDER_REFINE_MAX_BAD_MOVES 100    //moves without a cut improvement before a pass ends
+#define REORDER_IMBALANCE 0.03              //allowed imbalance of a bisection as a fraction of the vertex weight
+#define REORDER_LEAF_SIZE 8                 //vertex sets no larger than this keep their order
+
+//undirected weighted graph in compressed sparse rows
+class ReorderGraph
+{
+public:
+    uint size() const {return vertex_weights.size();}
+
+public:
+    QVector<uint> offsets;          //size()+1 offsets into adjacency and edge_weights
+    QVector<uint> adjacency;
+    QVector<uint> edge_weights;
+    QVector<uint> vertex_weights;
+};
+
+//connectivity of an index space which constrains reordering (connection NULL only pins the index spaces)
+class ReorderLink
+{
+public:
+    AbstractionConnection *connection;
+    QString row_component;
+    QString col_component;
+};
+
+//computes a permutation of the neuron indices of each population which clusters neurons connected by lists so that
+//contiguous sub populations connect to fewer sub populations. Populations which share an index space with another
+//population through one to one connectivity (or weight update inputs) are not reordered. Permutations map the original
+//index of a neuron to its new index and are applied to fully parsed populations before they are split.
+class Reorderer
+{
+public:
+    Reorderer(InfoParser *info);
+
+    void addPopulation(Population *population);     //records the index spaces and list connectivity of a parsed population
+    void reorder();                                 //computes the permutations (all populations must have been added)
+    void remapPopulation(Population *population);   //applies the permutations to value lists and connection lists
+    void remapLogOutputs(Experiment *experiment);
+    void writePermutations(QString filename);       //'population_name new_index_0 new_index_1 ...' per reordered population
+    uint getReorderedCount();
+
+private:
+    void addInputs(Component *component, QString component_space);
+    QString populationOf(QString component_name);
+    const QVector<uint> &permutationOf(QString component_name);
+    void remapInputs(Component *component, QString component_space);
+
+    ReorderGraph buildGraph(const QStringList &reordered, QHash<QString, uint> &global_offsets);
+    void orderVertices(const ReorderGraph &graph, const QVector<uint> &vertices, QVector<uint> &order);
+    ReorderGraph inducedGraph(const ReorderGraph &graph, const QVector<uint> &vertices);
+    QVector<uint> bisect(const ReorderGraph &graph);
+    ReorderGraph coarsen(const ReorderGraph &graph, QVector<uint> &coarse_map);
+    QVector<uint> initialBisection(const ReorderGraph &graph);
+    void refine(const ReorderGraph &graph, QVector<uint> &side);
+
+private:
+    InfoParser *info;
+    QStringList population_names;                   //document order
+    QHash<QString, QString> component_populations;  //population providing the index space of a population or postsynapse
+    QHash<QString, QPair<QString, QString> > all_to_all_weight_updates; //(src, dst) populations of weight updates indexed by src*dst_size+dst
+    QList<ReorderLink> links;
+    QHash<QString, QVector<uint> > permutations;    //original neuron index -> new neuron index by population name
+    QVector<uint> identity;                         //empty permutation
+    QVector<int> local_index;                       //scratch map of graph vertices to induced graph vertices
+};
+
+#endif // REORDERER_H
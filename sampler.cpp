@@ -0,0 +1,85 @@
+#include "sampler.h"
+#include "philox.h"
+
+#include <cmath>
+
+bool PropertySampler::isStochastic(PropertyValue *value)
+{
+    switch(value->Type()){
+        case(UNIFORM_DISTRIBUTION_STOCHASTIC_TYPE):
+        case(NORMAL_DISTRIBUTION_STOCHASTIC_TYPE):
+        case(POISSON_DISTRIBUTION_STOCHASTIC_TYPE):
+            return true;
+        default:
+            return false;
+    }
+}
+
+double PropertySampler::sample(PropertyValue *value, quint64 index)
+{
+    switch(value->Type()){
+        case(UNIFORM_DISTRIBUTION_STOCHASTIC_TYPE):{
+            UniformDistPropertyValue *uniform_value = (UniformDistPropertyValue*)value;
+            quint32 random[4];
+            generate(uniform_value->seed, index, 0, random);
+            return uniform_value->minimum + uniform(random[0])*(uniform_value->maximum - uniform_value->minimum);
+        }
+        case(NORMAL_DISTRIBUTION_STOCHASTIC_TYPE):{
+            NormalDistPropertyValue *normal_value = (NormalDistPropertyValue*)value;
+            return normal_value->mean + sqrt(normal_value->variance)*normal(normal_value->seed, index, 0);
+        }
+        case(POISSON_DISTRIBUTION_STOCHASTIC_TYPE):{
+            PoissonDistPropertyValue *poisson_value = (PoissonDistPropertyValue*)value;
+            return poisson(poisson_value->seed, index, poisson_value->mean);
+        }
+        default:
+            return 0;
+    }
+}
+
+void PropertySampler::generate(int seed, quint64 index, quint32 block, quint32 random[4])
+{
+    quint32 key[2] = {(quint32)seed, SAMPLER_STREAM};
+    quint32 counter[4] = {(quint32)index, (quint32)(index >> 32), block, SAMPLER_STREAM};
+    Philox4x32::generate(counter, key, random);
+}
+
+double PropertySampler::uniform(quint32 random)
+{
+    return (random + 0.5) / 4294967296.0;
+}
+
+double PropertySampler::normal(int seed, quint64 index, quint32 block)
+{
+    //Box-Muller
+    quint32 random[4];
+    generate(seed, index, block, random);
+    return sqrt(-2.0*log(uniform(random[0]))) * cos(2.0*M_PI*uniform(random[1]));
+}
+
+double PropertySampler::poisson(int seed, quint64 index, double mean)
+{
+    if (mean <= 0)
+        return 0;
+
+    //normal approximation for large means
+    if (mean > SAMPLER_POISSON_DIRECT_MEAN){
+        double value = floor(mean + sqrt(mean)*normal(seed, index, 0) + 0.5);
+        return (value < 0) ? 0 : value;
+    }
+
+    //multiply uniforms until the product falls below exp(-mean) (four uniforms per generated block)
+    double limit = exp(-mean);
+    double product = 1.0;
+    uint count = 0;
+    quint32 random[4];
+    for (quint32 block=0; ; block++){
+        generate(seed, index, block, random);
+        for (uint k=0; k<4; k++){
+            product *= uniform(random[k]);
+            if (product <= limit)
+                return count;
+            count++;
+        }
+    }
+}
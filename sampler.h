@@ -0,0 +1,25 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <QtGlobal>
+#include "modelobjects.h"
+
+#define SAMPLER_STREAM 0x70726f70u      //counter word separating sampled values from generated connectivity
+#define SAMPLER_POISSON_DIRECT_MEAN 30.0 //poisson values with larger means are sampled from the normal approximation
+
+//samples stochastic property values with the Philox generator keyed by the seed of the distribution and counted by the
+//global index of the neuron or connection, so a sampled value does not depend on the partition or the sampling thread
+class PropertySampler
+{
+public:
+    static bool isStochastic(PropertyValue *value);
+    static double sample(PropertyValue *value, quint64 index);
+
+private:
+    static void generate(int seed, quint64 index, quint32 block, quint32 random[4]);
+    static double uniform(quint32 random);  //in (0,1)
+    static double normal(int seed, quint64 index, quint32 block);
+    static double poisson(int seed, quint64 index, double mean);
+};
+
+#endif // SAMPLER_H
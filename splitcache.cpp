@@ -0,0 +1,195 @@
+#include "splitcache.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QMutexLocker>
+
+
+CacheStamp::CacheStamp()
+{
+    modified = 0;
+    size = 0;
+}
+
+bool CacheStamp::stamp(QString filename)
+{
+    QFileInfo file_info(filename);
+    hash = hashFile(filename);
+    if (hash.isEmpty())
+        return false;
+    modified = file_info.lastModified().toMSecsSinceEpoch();
+    size = file_info.size();
+    return true;
+}
+
+bool CacheStamp::isCurrent(QString filename)
+{
+    //unchanged modification time and size are trusted, otherwise the contents are hashed
+    QFileInfo file_info(filename);
+    if (!file_info.exists())
+        return false;
+    qint64 file_modified = file_info.lastModified().toMSecsSinceEpoch();
+    if ((file_modified == modified) && (file_info.size() == size))
+        return true;
+    QByteArray file_hash = hashFile(filename);
+    if (file_hash.isEmpty() || (file_hash != hash))
+        return false;
+    modified = file_modified;
+    size = file_info.size();
+    return true;
+}
+
+QByteArray CacheStamp::hashFile(QString filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    QCryptographicHash file_hash(QCryptographicHash::Sha1);
+    if (!file_hash.addData(&file))
+        return QByteArray();
+    return file_hash.result();
+}
+
+
+
+SplitCache::SplitCache()
+{
+    connection_bytes = 0;
+    info_hits = 0;
+    info_misses = 0;
+    connection_hits = 0;
+    connection_misses = 0;
+}
+
+SplitCache::~SplitCache()
+{
+    clear();
+}
+
+bool SplitCache::restoreInfo(QString network_filename, InfoParser *info)
+{
+    QMutexLocker locker(&mutex);
+    QString key = QFileInfo(network_filename).absoluteFilePath();
+    QHash<QString, CachedInfo>::iterator entry = info_entries.find(key);
+    if ((entry == info_entries.end()) || (!entry.value().info->isPartitionedAs(info))){
+        info_misses++;
+        return false;
+    }
+    if (!entry.value().stamp.isCurrent(key)){
+        delete entry.value().info;
+        info_entries.erase(entry);
+        info_misses++;
+        return false;
+    }
+    info->copyInfo(entry.value().info);
+    info_hits++;
+    return true;
+}
+
+void SplitCache::storeInfo(QString network_filename, InfoParser *info)
+{
+    QMutexLocker locker(&mutex);
+    QString key = QFileInfo(network_filename).absoluteFilePath();
+    CachedInfo entry;
+    if (!entry.stamp.stamp(key))
+        return;
+    entry.info = new InfoParser(NULL);
+    entry.info->copyInfo(info);
+    if (info_entries.contains(key))
+        delete info_entries[key].info;
+    info_entries[key] = entry;
+}
+
+bool SplitCache::restoreConnections(BinaryConnectionFile &file)
+{
+    QMutexLocker locker(&mutex);
+    QString key = connectionsKey(file);
+    QHash<QString, CachedConnections>::iterator entry = connection_entries.find(key);
+    if (entry == connection_entries.end()){
+        connection_misses++;
+        return false;
+    }
+    if (!entry.value().stamp.isCurrent(file.filename)){
+        connection_bytes -= (quint64)(entry.value().src_neurons.size() + entry.value().dst_neurons.size() + entry.value().delays.size()) * sizeof(uint);
+        connection_entries.erase(entry);
+        connection_order.removeOne(key);
+        connection_misses++;
+        return false;
+    }
+
+    //vectors are implicitly shared with the cache (not copied)
+    file.src_neurons = entry.value().src_neurons;
+    file.dst_neurons = entry.value().dst_neurons;
+    file.delays = entry.value().delays;
+    file.max_src_neuron = entry.value().max_src_neuron;
+    file.max_dst_neuron = entry.value().max_dst_neuron;
+    connection_hits++;
+    return true;
+}
+
+void SplitCache::storeConnections(const BinaryConnectionFile &file)
+{
+    QMutexLocker locker(&mutex);
+    QString key = connectionsKey(file);
+    if (connection_entries.contains(key))
+        return;
+    CachedConnections entry;
+    if (!entry.stamp.stamp(file.filename))
+        return;
+    entry.src_neurons = file.src_neurons;
+    entry.dst_neurons = file.dst_neurons;
+    entry.delays = file.delays;
+    entry.max_src_neuron = file.max_src_neuron;
+    entry.max_dst_neuron = file.max_dst_neuron;
+    connection_entries.insert(key, entry);
+    connection_order.append(key);
+    connection_bytes += (quint64)(entry.src_neurons.size() + entry.dst_neurons.size() + entry.delays.size()) * sizeof(uint);
+    evictConnections();
+}
+
+QString SplitCache::definition(const QString &url)
+{
+    QMutexLocker locker(&mutex);
+    QSet<QString>::const_iterator i = definitions.constFind(url);
+    if (i != definitions.constEnd())
+        return *i;
+    definitions.insert(url);
+    return url;
+}
+
+void SplitCache::clear()
+{
+    QMutexLocker locker(&mutex);
+    for (QHash<QString, CachedInfo>::iterator i = info_entries.begin(); i != info_entries.end(); ++i)
+        delete i.value().info;
+    info_entries.clear();
+    connection_entries.clear();
+    connection_order.clear();
+    connection_bytes = 0;
+    definitions.clear();
+}
+
+QString SplitCache::report()
+{
+    QMutexLocker locker(&mutex);
+    return QString("info %1 hits %2 misses, connections %3 hits %4 misses (%5 MB), %6 definitions")
+            .arg(info_hits).arg(info_misses).arg(connection_hits).arg(connection_misses)
+            .arg(connection_bytes / (1024*1024)).arg(definitions.size());
+}
+
+QString SplitCache::connectionsKey(const BinaryConnectionFile &file)
+{
+    return QString("%1:%2:%3").arg(QFileInfo(file.filename).absoluteFilePath()).arg(file.num_connections).arg(file.explicit_delay ? 1 : 0);
+}
+
+void SplitCache::evictConnections()
+{
+    //least recently stored files are dropped first (the newest file is always kept)
+    while ((connection_bytes > SPLIT_CACHE_MAX_CONNECTION_BYTES) && (connection_order.size() > 1)){
+        CachedConnections &entry = connection_entries[connection_order.first()];
+        connection_bytes -= (quint64)(entry.src_neurons.size() + entry.dst_neurons.size() + entry.delays.size()) * sizeof(uint);
+        connection_entries.remove(connection_order.takeFirst());
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef SPLITCACHE_H
+#define SPLITCACHE_H
+
+#include <QString>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QVector>
+#include <QMutex>
+#include "infoparser.h"
+#include "binaryconnectionfile.h"
+
+#define SPLIT_CACHE_MAX_CONNECTION_BYTES (1024*1024*1024)   //decoded binary connection data held between splits
+
+//modification time, size and content hash of a cached file. An entry is current while the modification time and size
+//are unchanged or, if they have changed, while the contents still hash to the same value.
+class CacheStamp
+{
+public:
+    CacheStamp();
+
+    bool stamp(QString filename);      //false if the file could not be read
+    bool isCurrent(QString filename);  //refreshes the modification time and size of an unchanged file
+
+    static QByteArray hashFile(QString filename);  //empty if the file could not be read
+
+public:
+    qint64 modified;
+    qint64 size;
+    QByteArray hash;
+};
+
+class CachedInfo
+{
+public:
+    CacheStamp stamp;
+    InfoParser *info;       //tables of the info parse (no xml source)
+};
+
+class CachedConnections
+{
+public:
+    CacheStamp stamp;
+    QVector<uint> src_neurons;
+    QVector<uint> dst_neurons;
+    QVector<uint> delays;
+    uint max_src_neuron;
+    uint max_dst_neuron;
+};
+
+//data of previous splits kept by a resident splitter: the info parse of each network file, the decoded connections of
+//each binary connection file and the definition urls of components. Entries are invalidated when their file changes.
+//Lookups are thread safe (binary files are loaded by concurrent range parsers).
+class SplitCache
+{
+public:
+    SplitCache();
+    ~SplitCache();
+
+    bool restoreInfo(QString network_filename, InfoParser *info);  //false if not cached, changed or partitioned differently
+    void storeInfo(QString network_filename, InfoParser *info);
+    bool restoreConnections(BinaryConnectionFile &file);           //false if not cached or changed
+    void storeConnections(const BinaryConnectionFile &file);
+    QString definition(const QString &url);                         //shared copy of the url
+
+    void clear();
+    QString report();
+
+private:
+    QString connectionsKey(const BinaryConnectionFile &file);
+    void evictConnections();
+
+private:
+    QMutex mutex;
+    QHash<QString, CachedInfo> info_entries;              //by absolute network file name
+    QHash<QString, CachedConnections> connection_entries; //by absolute file name, connection count and delay flag
+    QList<QString> connection_order;                      //least recently stored first
+    quint64 connection_bytes;
+    QSet<QString> definitions;
+
+    uint info_hits;
+    uint info_misses;
+    uint connection_hits;
+    uint connection_misses;
+};
+
+#endif // SPLITCACHE_H
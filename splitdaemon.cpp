@@ -0,0 +1,193 @@
+#include "splitdaemon.h"
+
+#include <iostream>
+#include <string>
+#include <QCoreApplication>
+#include <QDebug>
+
+
+SplitDaemon::SplitDaemon(QString socket_name, bool silent)
+{
+    this->socket_name = socket_name;
+    this->silent = silent;
+    worker = NULL;
+    served_requests = 0;
+    failed_workers = 0;
+}
+
+SplitDaemon::~SplitDaemon()
+{
+    stopWorker();
+    server.close();
+}
+
+bool SplitDaemon::listen()
+{
+    //a socket left by a daemon which did not shut down is removed
+    QLocalServer::removeServer(socket_name);
+    if (!server.listen(socket_name)){
+        std::cerr << "Error: Could not listen on socket '" << socket_name.toLocal8Bit().data() << "': " << server.errorString().toLocal8Bit().data() << std::endl;
+        return false;
+    }
+    if (!silent)
+        qDebug() << "Splitter daemon listening on " << server.fullServerName();
+    return true;
+}
+
+void SplitDaemon::run()
+{
+    bool running = true;
+    while (running){
+        if (!server.waitForNewConnection(-1))
+            continue;
+        while (running && server.hasPendingConnections()){
+            QLocalSocket *socket = server.nextPendingConnection();
+            running = serve(socket);
+            socket->disconnectFromServer();
+            if (socket->state() != QLocalSocket::UnconnectedState)
+                socket->waitForDisconnected(DAEMON_REQUEST_TIMEOUT);
+            delete socket;
+        }
+    }
+    stopWorker();
+    server.close();
+    if (!silent)
+        qDebug() << "Splitter daemon stopped after " << served_requests << " requests";
+}
+
+bool SplitDaemon::serve(QLocalSocket *socket)
+{
+    //requests are single lines so a client may connect once per request or send several requests on one connection
+    while (true){
+        while (!socket->canReadLine()){
+            if (!socket->waitForReadyRead(DAEMON_REQUEST_TIMEOUT))
+                return true;
+        }
+        QString line = QString::fromLocal8Bit(socket->readLine()).trimmed();
+        if (line.isEmpty())
+            continue;
+
+        if (line == "shutdown"){
+            reply(socket, "OK shutdown");
+            return false;
+        }
+        if (line == "stats"){
+            QString cache_report = forward(line);
+            if (cache_report.startsWith("OK "))
+                cache_report = cache_report.mid(3);
+            reply(socket, QString("OK %1 requests, %2 failed workers, %3").arg(served_requests).arg(failed_workers).arg(cache_report));
+            continue;
+        }
+
+        QString result = forward(line);
+        served_requests++;
+        reply(socket, result);
+        if (!silent)
+            qDebug() << "Request " << served_requests << ": " << result;
+    }
+}
+
+void SplitDaemon::reply(QLocalSocket *socket, QString line)
+{
+    socket->write(line.append('\n').toLocal8Bit());
+    socket->waitForBytesWritten(DAEMON_REQUEST_TIMEOUT);
+}
+
+QString SplitDaemon::forward(QString line)
+{
+    if (!startWorker())
+        return "ERROR Could not start a split worker";
+    worker_error.clear();
+    worker->write(line.append('\n').toLocal8Bit());
+
+    //output other than the reply (e.g. a split plan) is forwarded
+    while (true){
+        while (worker->canReadLine()){
+            QString output = QString::fromLocal8Bit(worker->readLine());
+            if (output.startsWith(DAEMON_WORKER_REPLY)){
+                readWorkerErrors();
+                return output.mid(QString(DAEMON_WORKER_REPLY).size()).trimmed();
+            }
+            if (!silent)
+                std::cout << output.toLocal8Bit().data() << std::flush;
+        }
+        readWorkerErrors();
+        if (worker->state() == QProcess::NotRunning)
+            break;
+        worker->waitForReadyRead(-1);   //false once the worker has finished
+    }
+
+    //the worker ended without a reply (the cache of the worker is lost)
+    readWorkerErrors();
+    delete worker;
+    worker = NULL;
+    worker_errors.clear();
+    failed_workers++;
+    if (worker_error.isEmpty())
+        return "ERROR Split worker ended without a reply";
+    return "ERROR " + worker_error;
+}
+
+bool SplitDaemon::startWorker()
+{
+    if (worker != NULL)
+        return true;
+    worker = new QProcess();
+    worker->setProcessChannelMode(QProcess::SeparateChannels);
+    worker->start(QCoreApplication::applicationFilePath(), QStringList() << DAEMON_WORKER_ARGUMENT);
+    if (worker->waitForStarted(DAEMON_WORKER_TIMEOUT))
+        return true;
+    std::cerr << "Error: Could not start a split worker: " << worker->errorString().toLocal8Bit().data() << std::endl;
+    delete worker;
+    worker = NULL;
+    return false;
+}
+
+void SplitDaemon::stopWorker()
+{
+    //the worker stops once its input is closed
+    if (worker == NULL)
+        return;
+    worker->closeWriteChannel();
+    if (!worker->waitForFinished(DAEMON_WORKER_TIMEOUT))
+        worker->kill();
+    readWorkerErrors();
+    delete worker;
+    worker = NULL;
+    worker_errors.clear();
+}
+
+void SplitDaemon::readWorkerErrors()
+{
+    //errors of the splitter are single lines starting 'Error' written before the worker exits
+    worker_errors.append(worker->readAllStandardError());
+    int end;
+    while ((end = worker_errors.indexOf('\n')) >= 0){
+        QString line = QString::fromLocal8Bit(worker_errors.left(end)).trimmed();
+        worker_errors.remove(0, end+1);
+        if (line.startsWith("Error"))
+            worker_error = line;
+        if (!silent)
+            std::cerr << line.toLocal8Bit().data() << std::endl;
+    }
+}
+
+int SplitDaemon::runWorker(SplitRequestHandler handler)
+{
+    //requests are read from the daemon on stdin and replies written to stdout (prefixed as the split may also write to stdout)
+    SplitCache cache;
+    std::string input;
+    while (std::getline(std::cin, input)){
+        QString line = QString::fromLocal8Bit(input.c_str()).trimmed();
+        if (line.isEmpty())
+            continue;
+        QString result;
+        bool ok = true;
+        if (line == "stats")
+            result = cache.report();
+        else
+            ok = handler(line.split('\t', QString::SkipEmptyParts), &cache, result);
+        std::cout << DAEMON_WORKER_REPLY << (ok ? "OK " : "ERROR ") << result.toLocal8Bit().data() << std::endl;
+    }
+    return 0;
+}
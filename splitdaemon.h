@@ -0,0 +1,57 @@
+#ifndef SPLITDAEMON_H
+#define SPLITDAEMON_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QProcess>
+#include "splitcache.h"
+
+#define DAEMON_REQUEST_TIMEOUT 30000    //ms to wait for a complete request line from a connected client
+#define DAEMON_WORKER_TIMEOUT 30000     //ms to wait for a worker process to start or stop
+#define DAEMON_WORKER_ARGUMENT "-daemon_worker"     //command line of a worker process
+#define DAEMON_WORKER_REPLY "#reply "   //prefix of the reply lines of a worker (other output of the worker is forwarded)
+
+//splits the model of one request (the arguments of the command line) and sets the reply, false if the request was rejected
+typedef bool (*SplitRequestHandler)(const QStringList &arguments, SplitCache *cache, QString &reply);
+
+//resident splitter which serves split requests over a local (unix domain) socket so process start up is paid once and
+//the cache of previous splits is kept. A request is one line of tab separated arguments ('input_file output_file
+//[options]') and is answered with one line starting 'OK' or 'ERROR'. The lines 'stats' and 'shutdown' report the cache
+//and stop the daemon. Requests are served one at a time as each split already uses every core.
+//Errors within a split end the splitting process, so requests are split by a worker process which holds the cache. A
+//request which ends the worker is answered with the error written by the worker and the next request starts a new
+//worker (with an empty cache).
+class SplitDaemon
+{
+public:
+    SplitDaemon(QString socket_name, bool silent = false);
+    ~SplitDaemon();
+
+    bool listen();      //false if the socket could not be created
+    void run();         //serves requests until a shutdown request
+
+    static int runWorker(SplitRequestHandler handler);  //serves the requests of a daemon (stdin) until stdin is closed
+
+private:
+    bool serve(QLocalSocket *socket);   //false once shutdown is requested
+    void reply(QLocalSocket *socket, QString line);
+    QString forward(QString line);      //reply of the worker to a request line
+    bool startWorker();
+    void stopWorker();
+    void readWorkerErrors();
+
+private:
+    QString socket_name;
+    bool silent;
+    QLocalServer server;
+    QProcess *worker;
+    QByteArray worker_errors;   //incomplete last line of the worker error output
+    QString worker_error;       //last error reported by the worker during the current request
+    uint served_requests;
+    uint failed_workers;
+};
+
+#endif // SPLITDAEMON_H
@@ -2,17 +2,44 @@
 #include "xmlwriter.h"
 #include "aliaswriter.h"
 #include "graphwriter.h"
+#include "mappedinputfile.h"
+#include "partitioner.h"
+#include "reorderer.h"
+#include "philox.h"
+#include "sampler.h"
+#include "planner.h"
+#include "fanoutwriter.h"
 
 #include <QFile>
 #include <QFileInfo>
+#include <QDir>
+#include <QStringList>
+#include <QTextStream>
 #include <iostream>
 #include <QDebug>
 #include <omp.h>
+#include <algorithm>
+#include <climits>
 
 
 SpineMLSplitter::SpineMLSplitter(bool parallel, bool formatted_output, bool silent, WriterMode mode)
 {
     parser = NULL;
+    info_parser = NULL;
+    writer = NULL;
+    sink = NULL;
+    cache = NULL;
+    single_pass = false;
+    mapped_input = false;
+    partition_size = MAX_POPULATION_SIZE;
+    node_count = 1;
+    balanced = false;
+    reordered = false;
+    pipelined = false;
+    materialise_fixed_probability = false;
+    sampled_properties = false;
+    streamed = false;
+    planned = false;
     this->parallel = parallel;
     this->formatted_output = formatted_output;
     this->silent = silent;
@@ -34,6 +61,114 @@ SpineMLSplitter::~SpineMLSplitter()
 }
 
 void SpineMLSplitter::split(QString experiment_input_filename, QString network_output_filename)
+{
+    initialise();
+
+    //experiment file parse
+    parseExperimentFile(experiment_input_filename, network_output_filename);
+
+    //parser and info parser deleted by destructor
+}
+
+void SpineMLSplitter::splitBatch(QString manifest_filename)
+{
+    //experiments of the manifest are grouped by network file (in manifest order) so each network is parsed and split once
+    //and written to the output of every experiment of the group
+    QList<QString> experiment_filenames;
+    QList<QString> output_filenames;
+    loadManifestFile(manifest_filename, experiment_filenames, output_filenames);
+
+    QList<QString> network_filenames;
+    QHash<QString, QList<Experiment*> > group_experiments;
+    QHash<QString, QList<QString> > group_outputs;
+    initialise();
+    for (int i=0; i<experiment_filenames.size(); i++){
+        Experiment *experiment = parseExperiment(experiment_filenames[i]);
+        if (experiment == (Experiment*)0){
+            std::cerr << "Error: No 'Experiment' element found in experiment file: " << experiment_filenames[i].toLocal8Bit().data() << std::endl;
+            exit(0);
+        }
+        QString network_filename = QFileInfo(getNetworkFilename(experiment)).absoluteFilePath();
+        if (!group_experiments.contains(network_filename))
+            network_filenames.append(network_filename);
+        group_experiments[network_filename].append(experiment);
+        group_outputs[network_filename].append(output_filenames[i]);
+    }
+
+    uint batch_populations = 0;
+    uint batch_projections = 0;
+    uint batch_inputs = 0;
+    for (int n=0; n<network_filenames.size(); n++){
+        QList<Experiment*> experiments = group_experiments[network_filenames[n]];
+        QList<QString> outputs = group_outputs[network_filenames[n]];
+        if (!silent)
+            qDebug() << "Batch: Splitting " << network_filenames[n] << " for " << experiments.size() << " experiments";
+
+        //the first experiment is split as normal, the others are written by the same writer
+        initialise();
+        batch_experiments = experiments.mid(1);
+        batch_outputs = outputs.mid(1);
+        parseExperimentNetwork(experiments[0], outputs[0]);
+        batch_experiments.clear();
+        batch_outputs.clear();
+
+        batch_populations += split_populations;
+        batch_projections += split_projections;
+        batch_inputs += split_inputs;
+        for (int i=0; i<experiments.size(); i++)
+            delete experiments[i];
+    }
+
+    split_populations = batch_populations;
+    split_projections = batch_projections;
+    split_inputs = batch_inputs;
+}
+
+void SpineMLSplitter::splitBuffer(const QByteArray &network_data, SpineMLWriter *sink)
+{
+    //as split but the network document is already in memory and sub populations are passed to the sink (no experiment)
+    initialise();
+    this->sink = sink;
+
+    MappedInputFile input_file(network_data);
+    if (!input_file.open()) {
+        std::cerr << "Error opening in memory network document" << std::endl;
+        exit(0);
+    }
+    parseNetwork(input_file, NULL, QString());
+
+    this->sink = NULL;
+}
+
+void SpineMLSplitter::splitModel(const QVector<Population*> &populations, SplitterMode splitter_mode, SpineMLWriter *sink)
+{
+    //populations built in memory (connection lists compressed) are split as if parsed in a single pass. The populations
+    //remain owned by the caller but are modified (bucketed, and renumbered or rebalanced if requested).
+    initialise();
+    this->sink = sink;
+
+    info_parser->setSplitterMode(splitter_mode);
+    for (int i=0; i<populations.size(); i++)
+        info_parser->addParsedPopulation(populations[i]);
+    info_parser->calculateDimensions();
+    for (int i=0; i<populations.size(); i++)
+        parser->resolveDeferredPopulation(populations[i]);
+
+    //sub populations are allocated from an arena per population
+    QVector<Arena*> arenas;
+    for (int i=0; i<populations.size(); i++)
+        arenas.append(new Arena());
+    splitParsedNetwork(populations, arenas, false, NULL, QString());
+
+    this->sink = NULL;
+}
+
+void SpineMLSplitter::setSink(SpineMLWriter *sink)
+{
+    this->sink = sink;
+}
+
+void SpineMLSplitter::initialise()
 {
     if (parser)
         delete parser;
@@ -48,11 +183,79 @@ void SpineMLSplitter::split(QString experiment_input_filename, QString network_o
     //init
     info_parser = new InfoParser(&xml_src);
     parser = new Parser(&xml_src, info_parser);
+    parser->setCache(cache);
+
+    //partition sizes (must be known before the info parse calculates population splits)
+    QHash<QString, uint> partition_sizes;
+    if (!partition_filename.isEmpty())
+        loadPartitionFile(partition_sizes);
+    info_parser->setPartitionSizes(partition_size, partition_sizes);
+    info_parser->setNodeCount(node_count);
+}
 
-    //experiment file parse
-    parseExperimentFile(experiment_input_filename, network_output_filename);
+void SpineMLSplitter::setSinglePass(bool single_pass)
+{
+    this->single_pass = single_pass;
+}
 
-    //parser and info parser deleted by destructor
+void SpineMLSplitter::setMappedInput(bool mapped_input)
+{
+    this->mapped_input = mapped_input;
+}
+
+void SpineMLSplitter::setPartitionSize(uint partition_size)
+{
+    this->partition_size = partition_size;
+}
+
+void SpineMLSplitter::setPartitionFile(QString partition_filename)
+{
+    this->partition_filename = partition_filename;
+}
+
+void SpineMLSplitter::setBalanced(bool balanced)
+{
+    this->balanced = balanced;
+}
+
+void SpineMLSplitter::setReordered(bool reordered)
+{
+    this->reordered = reordered;
+}
+
+void SpineMLSplitter::setPipelined(bool pipelined)
+{
+    this->pipelined = pipelined;
+}
+
+void SpineMLSplitter::setMaterialiseFixedProbability(bool materialise_fixed_probability)
+{
+    this->materialise_fixed_probability = materialise_fixed_probability;
+}
+
+void SpineMLSplitter::setSampledProperties(bool sampled_properties)
+{
+    this->sampled_properties = sampled_properties;
+}
+
+void SpineMLSplitter::setStreamed(bool streamed)
+{
+    this->streamed = streamed;
+}
+
+void SpineMLSplitter::setPlanned(bool planned)
+{
+    this->planned = planned;
+}
+
+void SpineMLSplitter::setNodeCount(uint node_count)
+{
+    this->node_count = node_count;
+}
+
+void SpineMLSplitter::setCache(SplitCache *cache)
+{
+    this->cache = cache;
 }
 
 uint SpineMLSplitter::getSplitPopulationCount()
@@ -88,24 +291,111 @@ void SpineMLSplitter::parseExperimentNetwork(Experiment* experiment, QString net
 {
     //xml input
     qDebug() << "network_layer_url: " << experiment->network_layer_url << " network_output_filename: " << network_output_filename;
-    QFileInfo network_fileinfo(experiment->network_layer_url);
-
-    //QString dstproj_network_filename = "%1/%2_dstproj.xml";
-    QString dstproj_network_filename = "%1/%2.xml";
-    dstproj_network_filename = dstproj_network_filename.arg(network_fileinfo.absolutePath()).arg(network_fileinfo.baseName());
+    QString dstproj_network_filename = getNetworkFilename(experiment);
 
-    QFile input_file(dstproj_network_filename.toLocal8Bit().data());
+    MappedInputFile input_file(dstproj_network_filename, mapped_input);
 
-    if (!input_file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    if (!input_file.open()) {
         std::cerr << "Error opening network input file: " << dstproj_network_filename.toLocal8Bit().data() << std::endl;
         exit(0);
     }
-    xml_src.setDevice(&input_file);
+    parseNetwork(input_file, experiment, network_output_filename);
+}
 
-    //FIRST PASS PARSING: I.E. INFO PARSE
-    info_parser->parse();
+void SpineMLSplitter::parseNetwork(MappedInputFile &input_file, Experiment* experiment, QString network_output_filename)
+{
+    xml_src.setDevice(input_file.device());
+
+    //PLAN ONLY: I.E. INFO PARSE (no population is fully parsed and no writer is created)
+    if (planned){
+        parseInfo(input_file);
+        SplitPlanner planner(info_parser);
+        planner.plan();
+        planner.report();
+        input_file.close();
+        return;
+    }
+
+    //SINGLE PASS PARSING: I.E. INFO BUILT FROM FULLY PARSED POPULATIONS (balancing and reordering require the connectivity of every population before splitting)
+    if (single_pass || balanced || reordered){
+        parseAndSplitNetworkSinglePass(experiment, network_output_filename);
+        input_file.close();
+        return;
+    }
+
+    //FIRST PASS PARSING: I.E. INFO PARSE (or the cached info of an unchanged network file)
+    parseInfo(input_file);
 
     //INIT OUTPUT
+    createWriter(experiment, network_output_filename);
+
+    writer->writeDocumentStart();
+
+    //SECOND PASS PARSING. I.E. FULL PARSE (pipelined or parallel over population ranges of a mapped or in memory document if
+    //possible, streamed parses one population at a time). Unmapped files are streamed rather than read whole into memory.
+    bool range_parallel = parallel && !pipelined && !streamed && input_file.isResident();
+    if (!(range_parallel && parseAndSplitPopulationsParallel(input_file.data(), input_file.dataSize()))){
+        input_file.reset();
+        xml_src.setDevice(input_file.device());
+        if (pipelined)
+            parseAndSplitPopulationsPipelined();
+        else
+            parseAndSplitPopulations();
+    }
+
+    input_file.close();
+
+    //end writing
+    closeWriter();
+}
+
+void SpineMLSplitter::parseInfo(MappedInputFile &input_file)
+{
+    //the info parse of an unchanged network file is reused when resident (the xml source is not read)
+    QString network_filename = input_file.fileName();
+    if ((cache) && (!network_filename.isEmpty()) && (cache->restoreInfo(network_filename, info_parser)))
+        return;
+    info_parser->parse();
+
+    //the info parse reads the whole document so whether the range offsets are byte offsets is known without a further scan
+    info_parser->setByteOffsets(input_file.isAsciiRead());
+    if ((cache) && (!network_filename.isEmpty()))
+        cache->storeInfo(network_filename, info_parser);
+}
+
+void SpineMLSplitter::createWriter(Experiment* experiment, QString network_output_filename)
+{
+    //sub populations are passed to the sink of the caller if there is one
+    if (sink != NULL){
+        writer = sink;
+        return;
+    }
+    if (network_output_filename.isEmpty()){
+        std::cerr << "Error: No output file or sink to write the split network to" << std::endl;
+        exit(0);
+    }
+    //the node partition of each sub population is written alongside the output of hierarchical splits
+    if (node_count > 1){
+        writeNodeMap(network_output_filename + ".nodes");
+        for (int i=0; i<batch_outputs.size(); i++)
+            writeNodeMap(batch_outputs[i] + ".nodes");
+    }
+    if (batch_outputs.isEmpty()){
+        writer = createModeWriter(experiment, network_output_filename);
+        return;
+    }
+
+    //batch experiments sharing the network are written from the same split
+    FanOutWriter *fan_out_writer = new FanOutWriter();
+    fan_out_writer->addWriter(createModeWriter(experiment, network_output_filename));
+    for (int i=0; i<batch_outputs.size(); i++)
+        fan_out_writer->addWriter(createModeWriter(batch_experiments[i], batch_outputs[i]));
+    writer = fan_out_writer;
+}
+
+SpineMLWriter *SpineMLSplitter::createModeWriter(Experiment* experiment, QString network_output_filename)
+{
+    SpineMLWriter *writer = NULL;
     switch(mode){
     case(WRITER_MODE_XML):{
             writer = new SpineMLXMLWriter(network_output_filename, formatted_output);
@@ -116,6 +406,10 @@ void SpineMLSplitter::parseExperimentNetwork(Experiment* experiment, QString net
                 std::cerr << "DAMSON Alias mode (-alias) can only be used for projections specified at destination!" << std::endl;
                 exit(0);
             }
+            if (experiment == NULL){
+                std::cerr << "DAMSON Alias mode (-alias) requires an experiment!" << std::endl;
+                exit(0);
+            }
             writer = new DamsonAliasWriter(network_output_filename, info_parser, experiment);
             break;
         }
@@ -124,26 +418,42 @@ void SpineMLSplitter::parseExperimentNetwork(Experiment* experiment, QString net
             break;
         }
     }
+    return writer;
+}
 
-    writer->writeDocumentStart();
-
-    //SECOND PASS PARSING. I.E. FULL PARSE
-    input_file.reset();
-    xml_src.setDevice(&input_file);
-    parseAndSplitPopulations();
-
-    input_file.close();
 
-    //end writing
+void SpineMLSplitter::closeWriter()
+{
+    //the sink of the caller is ended but not closed or deleted
     writer->writeDocuemntEnd();
-    writer->close();
-
-    //cleanup
-    delete writer;
+    if (writer != sink){
+        writer->close();
+        delete writer;
+    }
+    writer = NULL;
 }
 
+QString SpineMLSplitter::getNetworkFilename(Experiment* experiment)
+{
+    QFileInfo network_fileinfo(experiment->network_layer_url);
+
+    //QString dstproj_network_filename = "%1/%2_dstproj.xml";
+    QString dstproj_network_filename = "%1/%2.xml";
+    return dstproj_network_filename.arg(network_fileinfo.absolutePath()).arg(network_fileinfo.baseName());
+}
 
 void SpineMLSplitter::parseExperimentFile(QString experiment_input_filename, QString network_output_filename)
+{
+    Experiment *experiment = parseExperiment(experiment_input_filename);
+
+    //parse and split the network
+    parseExperimentNetwork(experiment, network_output_filename);
+    if (experiment != (Experiment*)0) {
+        delete experiment;
+    }
+}
+
+Experiment *SpineMLSplitter::parseExperiment(QString experiment_input_filename)
 {
     Experiment *experiment = (Experiment*)0;
 
@@ -151,14 +461,14 @@ void SpineMLSplitter::parseExperimentFile(QString experiment_input_filename, QSt
         qDebug() << "*** Start Experiment Parsing";
 
 
-    QFile input_file(experiment_input_filename.toLocal8Bit().data());
-    QFileInfo input_info(input_file);
+    QFileInfo input_info(experiment_input_filename);
+    MappedInputFile input_file(experiment_input_filename, mapped_input);
 
-    if (!input_file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    if (!input_file.open()) {
         std::cerr << "Error opening experiment input file: " << experiment_input_filename.toLocal8Bit().data()  << std::endl;
         exit(0);
     }
-    xml_src.setDevice(&input_file);
+    xml_src.setDevice(input_file.device());
 
     //get the first (hopefully only) Experiment
     xml_src.readNextStartElement(); //read first 'spineml' element
@@ -179,11 +489,7 @@ void SpineMLSplitter::parseExperimentFile(QString experiment_input_filename, QSt
     if (PARSER_DEBUG_OUTPUT)
         qDebug() << "*** End Experiment Parsing";
 
-    //parse and split the network
-    parseExperimentNetwork(experiment, network_output_filename);
-    if (experiment != (Experiment*)0) {
-        delete experiment;
-    }
+    return experiment;
 }
 
 void SpineMLSplitter::parseAndSplitPopulations()
@@ -192,21 +498,290 @@ void SpineMLSplitter::parseAndSplitPopulations()
     if (PARSER_DEBUG_OUTPUT)
         qDebug() << "*** Start Full Network Parsing";
 
+    //windows of populations are parsed then split concurrently
+    uint window = (parallel && !streamed) ? SPLIT_POPULATION_WINDOW_PER_THREAD*omp_get_num_procs() : 1;
+    QVector<Population*> populations;
+    QVector<Arena*> arenas;
+
+    xml_src.readNextStartElement(); //read first 'spineml' element
+    bool more = true;
+    while (more) {
+         more = xml_src.readNextStartElement();
+         if (more && (xml_src.name() == "Population")){
+             //population and sub populations allocated from one arena which is freed once written
+             Arena *arena = new Arena();
+             ArenaScope arena_scope(arena);
+             populations.append(parser->parsePopulation());
+             arenas.append(arena);
+         }
+         //info parser already rejected groups
+         else if (more)
+             xml_src.skipCurrentElement();
+
+         //PERFORM SPLITTING
+         if (((uint)populations.size() == window) || (!more && !populations.isEmpty())){
+             splitAndWritePopulations(populations, arenas);
+             for (int i=0; i<populations.size(); i++){
+                 delete populations[i];
+                 delete arenas[i];
+             }
+             populations.clear();
+             arenas.clear();
+         }
+    }
+
+    if (PARSER_DEBUG_OUTPUT)
+        qDebug() << "*** End Full Network Parsing";
+}
+
+bool SpineMLSplitter::parseAndSplitPopulationsParallel(const char *network_data, qint64 network_size)
+{
+    //population ranges are character offsets so can only be used as byte offsets for ascii documents
+    if (!info_parser->hasByteOffsets())
+        return false;
+
+    //ranges must lie within the document and the reader of a range takes int sized blocks (otherwise populations are
+    //parsed serially over the whole document)
+    const QVector<PopulationRange> &ranges = info_parser->getPopulationRanges();
+    if ((info_parser->getHeaderLength() > INT_MAX) || (info_parser->getHeaderLength() > network_size))
+        return false;
+    for (int i=0; i<ranges.size(); i++){
+        if ((ranges[i].char_end - ranges[i].char_start > INT_MAX) || (ranges[i].char_end > network_size))
+            return false;
+    }
+
+    if (PARSER_DEBUG_OUTPUT)
+        qDebug() << "*** Start Parallel Full Network Parsing";
+
+    //openmp threads
+    int iCPU = omp_get_num_procs();
+    omp_set_num_threads(iCPU);
+
+    //parse batches of populations in parallel then split and write in document order
+    Population **populations = new Population*[iCPU];
+    Arena *arenas = new Arena[iCPU];
+    Parser **range_parsers = new Parser*[iCPU];
+    for(int j=0; j<iCPU; j++){
+        range_parsers[j] = new Parser(NULL, info_parser);
+        range_parsers[j]->setCache(cache);
+    }
+
+    uint batches = UINT_DIV_CEIL((uint)ranges.size(), (uint)iCPU);
+    for(uint i=0; i<batches; i++){
+        uint batch_pops = qMin((uint)iCPU, ranges.size() - (i*iCPU));
+
+        #pragma omp parallel for schedule(dynamic)
+        for(uint j=0; j<batch_pops; j++){
+            ArenaScope arena_scope(&arenas[j]);
+            populations[j] = parsePopulationRange(network_data, ranges[j + (i*iCPU)], range_parsers[omp_get_thread_num()]);
+        }
+
+        //PERFORM SPLITTING
+        QVector<Population*> batch_populations;
+        QVector<Arena*> batch_arenas;
+        for(uint j=0; j<batch_pops; j++){
+            batch_populations.append(populations[j]);
+            batch_arenas.append(&arenas[j]);
+        }
+        splitAndWritePopulations(batch_populations, batch_arenas);
+        for(uint j=0; j<batch_pops; j++){
+            delete populations[j];
+            arenas[j].release();
+        }
+    }
+
+    //parser stats
+    for(int j=0; j<iCPU; j++){
+        parser->addParsedCounts(range_parsers[j]);
+        delete range_parsers[j];
+    }
+    delete [] range_parsers;
+    delete [] populations;
+    delete [] arenas;
+
+    if (PARSER_DEBUG_OUTPUT)
+        qDebug() << "*** End Parallel Full Network Parsing";
+
+    return true;
+}
+
+void SpineMLSplitter::parseAndSplitPopulationsPipelined()
+{
+    //parse population N+1, split population N and write population N-1 concurrently. Each stage takes populations in
+    //document order so the output is unchanged and the bounded queues limit the populations held in memory.
+    PipelineQueue parsed_queue;
+    PipelineQueue split_queue;
+
+    if (PARSER_DEBUG_OUTPUT)
+        qDebug() << "*** Start Pipelined Full Network Parsing";
+
+    xml_src.readNextStartElement(); //read first 'spineml' element
+
+    //split tasks run within the split stage (the nesting of the caller is restored once the pipeline ends)
+    int max_active_levels = omp_get_max_active_levels();
+    omp_set_max_active_levels(qMax(max_active_levels, 2));
+    #pragma omp parallel sections num_threads(3)
+    {
+        #pragma omp section
+        {
+            //PARSE (population and sub populations allocated from one arena which is freed once written)
+            while (xml_src.readNextStartElement()) {
+                if (xml_src.name() == "Population"){
+                    PipelineItem *item = new PipelineItem();
+                    item->arena = new Arena();
+                    ArenaScope arena_scope(item->arena);
+                    item->population = parser->parsePopulation();
+                    parsed_queue.push(item);
+                }
+                //info parser already rejected groups
+                else
+                    xml_src.skipCurrentElement();
+            }
+            parsed_queue.push(NULL);
+        }
+        #pragma omp section
+        {
+            //SPLIT
+            while (PipelineItem *item = parsed_queue.pop()){
+                ArenaScope arena_scope(item->arena);
+                PopulationPartition partition = info_parser->getPartition(item->population->neuron->name);
+                item->sub_pop_count = partition.count();
+                item->sub_pops = new Population[item->sub_pop_count];
+                bucketListConnections(item->population);
+                splitSubPopulations(item->population, item->sub_pops, 0, item->sub_pop_count, partition);
+                split_queue.push(item);
+            }
+            split_queue.push(NULL);
+        }
+        #pragma omp section
+        {
+            //WRITE
+            while (PipelineItem *item = split_queue.pop()){
+                writeSubPopulations(item->population, item->sub_pops, item->sub_pop_count);
+                delete [] item->sub_pops;
+                delete item->population;
+                delete item->arena;
+                delete item;
+            }
+        }
+    }
+    omp_set_max_active_levels(max_active_levels);
+
+    if (PARSER_DEBUG_OUTPUT)
+        qDebug() << "*** End Pipelined Full Network Parsing";
+}
+
+Population *SpineMLSplitter::parsePopulationRange(const char *network_data, const PopulationRange &range, Parser *range_parser)
+{
+    //reader over the document header (for namespaces), the population range and the closing root element
+    QXmlStreamReader range_xml;
+    range_xml.addData(QByteArray::fromRawData(network_data, info_parser->getHeaderLength()));
+    range_xml.addData(QByteArray::fromRawData(network_data + range.char_start, range.char_end - range.char_start));
+    range_xml.addData(QByteArray("</SpineML>"));
+
+    range_xml.readNextStartElement(); //read first 'spineml' element
+    range_xml.readNextStartElement(); //read population element
+
+    //line numbers of errors relative to the network file
+    range_parser->setXmlSource(&range_xml);
+    range_parser->setLineOffset(range.line_start - info_parser->getHeaderLines());
+    Population *population = range_parser->parsePopulation();
+    range_parser->setXmlSource(NULL);
+    return population;
+}
+
+void SpineMLSplitter::parseAndSplitNetworkSinglePass(Experiment* experiment, QString network_output_filename)
+{
+    //populations are fully parsed in one pass and held until the info of every population is known (memory for file io)
+    QVector<Population*> populations;
+    QVector<Arena*> arenas;
+
+    if (PARSER_DEBUG_OUTPUT)
+        qDebug() << "*** Start Single Pass Network Parsing";
+
     xml_src.readNextStartElement(); //read first 'spineml' element
+    if (!(xml_src.isStartElement() && xml_src.name() == "SpineML"))
+    {
+        std::cerr << "Error (line " << xml_src.lineNumber() << "): XML model file is not a SpineML LL document!" << std::endl;
+        exit(0);
+    }
+    parser->setDeferredInfo(true);
     while (xml_src.readNextStartElement()) {
          if (xml_src.name() == "Population"){
+             Arena *arena = new Arena();
+             ArenaScope arena_scope(arena);
              Population *population = parser->parsePopulation();
-             //PERFORM SPLITTING
-             splitPopulationExplicit(population, population->neuron->size);
-             delete population;
+             info_parser->addParsedPopulation(population);
+             populations.append(population);
+             arenas.append(arena);
+         }
+         else if (xml_src.name() == "ComponenentInstance"){
+             std::cerr << "Error (line " << xml_src.lineNumber() << "): XML model file contains groups. These must be converted to populations!" << std::endl;
+             exit(0);
          }
-         //info parser already rejected groups
          else
              xml_src.skipCurrentElement();
     }
+    parser->setDeferredInfo(false);
+    info_parser->calculateDimensions();
+
+    //checks which require the info of populations later in the document
+    for (int i=0; i<populations.size(); i++)
+        parser->resolveDeferredPopulation(populations[i]);
 
     if (PARSER_DEBUG_OUTPUT)
-        qDebug() << "*** End Full Network Parsing";
+        qDebug() << "*** End Single Pass Network Parsing";
+
+    splitParsedNetwork(populations, arenas, true, experiment, network_output_filename);
+}
+
+void SpineMLSplitter::splitParsedNetwork(const QVector<Population*> &populations, const QVector<Arena*> &arenas, bool owns_populations, Experiment* experiment, QString network_output_filename)
+{
+    //renumber neurons so that connected neurons share sub populations (the permutation is written alongside the output)
+    if (reordered){
+        Reorderer reorderer(info_parser);
+        for (int i=0; i<populations.size(); i++)
+            reorderer.addPopulation(populations[i]);
+        reorderer.reorder();
+        for (int i=0; i<populations.size(); i++)
+            reorderer.remapPopulation(populations[i]);
+        if (experiment != NULL)
+            reorderer.remapLogOutputs(experiment);
+        if (!network_output_filename.isEmpty())
+            reorderer.writePermutations(network_output_filename + ".permutation");
+        for (int i=0; i<batch_outputs.size(); i++){
+            reorderer.remapLogOutputs(batch_experiments[i]);
+            reorderer.writePermutations(batch_outputs[i] + ".permutation");
+        }
+        if (!silent)
+            qDebug() << "Reordered " << reorderer.getReorderedCount() << " populations";
+    }
+
+    //replace uniform partitions with partitions of balanced work
+    if (balanced){
+        Partitioner partitioner(info_parser);
+        for (int i=0; i<populations.size(); i++)
+            partitioner.addPopulation(populations[i]);
+        partitioner.balance();
+    }
+
+    //INIT OUTPUT
+    createWriter(experiment, network_output_filename);
+    writer->writeDocumentStart();
+
+    //split windows of populations concurrently (written in document order)
+    int window = parallel ? SPLIT_POPULATION_WINDOW_PER_THREAD*omp_get_num_procs() : 1;
+    for (int first=0; first<populations.size(); first+=window){
+        splitAndWritePopulations(populations.mid(first, window), arenas.mid(first, window));
+        for (int i=first; i<qMin(first+window, populations.size()); i++){
+            if (owns_populations)
+                delete populations[i];
+            delete arenas[i];
+        }
+    }
+
+    //end writing
+    closeWriter();
 }
 
 
@@ -215,191 +790,402 @@ void SpineMLSplitter::parseAndSplitPopulations()
 
 /******************splitter****************/
 
-void SpineMLSplitter::splitPopulation(Population *population, uint component_size)
+void SpineMLSplitter::bucketListConnections(Population *population)
 {
-    uint num_src_sub_comps = UINT_DIV_CEIL(component_size, MAX_POPULATION_SIZE);
+    //bucket list connections by sub population once per synapse (rather than once per sub population)
+    PopulationPartition partition = info_parser->getPartition(population->neuron->name);
+    for (int p=0;p<population->projections.values().size();p++){
+        Projection *projection = population->projections.values()[p];
+        for (int c=0;c<projection->synapses.values().size();c++){
+            Synapse* synapse = projection->synapses.values()[c];
+            if (synapse->connection->Type() == LIST_CONNECTVITY_TYPE)
+                ((ConnectionList*)synapse->connection)->buildBuckets(partition, info_parser->getPartition(projection->proj_population));
+        }
+    }
+}
 
-    if(parallel){
-        temp_time = timer.elapsed();
+void SpineMLSplitter::splitPopulation(Population *population)
+{
+    //sub populations are split in windows and written as each window completes so only one window of sub populations
+    //is held in memory. Windows are allocated from their own arena which is released once written. The writer requires
+    //the maximum sub synapse and sub input counts before the first sub population is written so these are counted first.
+    PopulationPartition partition = info_parser->getPartition(population->neuron->name);
+    uint num_src_sub_comps = partition.count();
+    bucketListConnections(population);
+    countSplitMaxima(population, partition);
+
+    Arena window_arena;
+    ArenaScope arena_scope(&window_arena);
+    uint window = parallel ? SPLIT_WINDOW_PER_THREAD*omp_get_num_procs() : 1;
+    for(uint first=0; first<num_src_sub_comps; first+=window)
+    {
+        uint count = qMin(window, num_src_sub_comps - first);
+        Population *sub_pops = new Population[count];
+        splitSubPopulations(population, sub_pops, first, count, partition);
+        for(uint j=0; j<count;j++)        //WRITE
+        {
+            writer->writePopulation((Population*)&sub_pops[j], population);
+            if (!silent)
+                qDebug() << "Written " << (&sub_pops[j])->neuron->name << " sub " << first+j;
+        }
+        delete [] sub_pops;
+        window_arena.release();
+    }
+}
 
-        //openmp threads
-        int iCPU = omp_get_num_procs();
-        omp_set_num_threads(iCPU);
+void SpineMLSplitter::writeSubPopulations(Population *population, Population *sub_pops, uint count)
+{
+    for(uint i=0; i<count;i++)
+    {
+        writer->writePopulation((Population*)&sub_pops[i], population);
+        if (!silent)
+            qDebug() << "Written " << (&sub_pops[i])->neuron->name << " sub " << i;
+    }
+}
 
-        uint batches = UINT_DIV_CEIL(num_src_sub_comps, iCPU);
-        for(uint i=0; i<batches; i++){
-            //number of sub components in batch
-            uint batch_sub_comps = iCPU;
-            if ((i+1) == batches){
-                batch_sub_comps = num_src_sub_comps % iCPU;
-                if (batch_sub_comps == 0)
-                    batch_sub_comps = iCPU;
-            }
+void SpineMLSplitter::splitSubPopulations(Population *population, Population *sub_pops, uint first, uint count, const PopulationPartition &partition)
+{
+    //populations with little work are split serially as the thread team startup would dominate
+    bool parallel_split = parallel && (count > 1) && (splitWork(population) >= SPLIT_SERIAL_GRAIN);
+
+    //the single thread need not be the calling thread so takes the arena of the calling thread
+    Arena *arena = Arena::current();
+    temp_time = timer.elapsed();
+    if (parallel_split)
+        omp_set_num_threads(omp_get_num_procs());
+    #pragma omp parallel if(parallel_split)
+    {
+        #pragma omp single
+        {
+            ArenaScope arena_scope(arena);
+            splitSubPopulationTasks(population, sub_pops, first, count, partition);
+        }
+    }
+    split_time += timer.elapsed() - temp_time;
+}
 
-            Population *sub_pops = new Population[batch_sub_comps];
-            #pragma omp parallel for
-            for(uint j=0; j<batch_sub_comps;j++)
-            {
-                //SPLIT
-                uint sub_pop_index = j + (i*iCPU);
-                #pragma omp atomic
-                ++split_populations;
-                Population *sub_pop = &sub_pops[j];
-                sub_pop->neuron = new Neuron();
-                splitNeuron(population->neuron, sub_pop->neuron, sub_pop_index, num_src_sub_comps);
-                splitProjections(population, sub_pop, sub_pop_index);
-                if (!silent)
-                    qDebug() << "Split " << population->neuron->name << " sub " << sub_pop_index;
+void SpineMLSplitter::splitSubPopulationTasks(Population *population, Population *sub_pops, uint first, uint count, const PopulationPartition &partition)
+{
+    //each sub population is an openmp task so idle threads take the next sub population rather than waiting for a batch
+    //to finish (called by one thread of a parallel region, returns once every sub population is split)
+    Arena *arena = Arena::current();
+    SplitMaxima maxima;     //shared by the tasks (a local of the generating thread is otherwise firstprivate in each task)
+    for(uint i=0; i<count; i++)
+    {
+        #pragma omp task shared(maxima)
+        {
+            //SPLIT (sub populations allocated from the arena of the population)
+            ArenaScope arena_scope(arena);
+            SplitMaxima task_maxima;
+            uint sub_pop_index = first + i;
+            #pragma omp atomic
+            ++split_populations;
+            Population *sub_pop = &sub_pops[i];
+            sub_pop->neuron = new Neuron();
+            splitNeuron(population->neuron, sub_pop->neuron, sub_pop_index, partition, task_maxima);
+            splitProjections(population, sub_pop, sub_pop_index, task_maxima);
+            if (partition.isHierarchical())
+                countNodeMaxima(population, sub_pop, sub_pop_index, partition, task_maxima);
+            #pragma omp critical(split_maxima)
+            maxima.merge(task_maxima);
+            if (!silent)
+                qDebug() << "Split " << population->neuron->name << " sub " << sub_pop_index;
+        }
+    }
+    #pragma omp taskwait
+
+    //the maxima are required by the writer
+    maxima.reduce();
+}
+
+void SpineMLSplitter::countNodeMaxima(Population *population, Population *sub_pop, uint sub_pop_index, const PopulationPartition &partition, SplitMaxima &maxima)
+{
+    //node k of every population shares a node so sub synapses and sub inputs are within the node partition if the target
+    //(or source) sub population is in the same node partition of its own population
+    uint node = partition.node(sub_pop_index);
+
+    //sub synapses by the node of their target sub population
+    QHash<Synapse*, uint> node_synapses;
+    QHash<Synapse*, uint> remote_synapses;
+    for (int p=0; p<population->projections.values().size(); p++){
+        Projection *projection = population->projections.values()[p];
+        PopulationPartition target_partition = info_parser->getPartition(projection->proj_population);
+        for (uint d=0; d<target_partition.count(); d++){
+            Projection *sub_projection = sub_pop->projections.value(getSubName(projection->proj_population, d), NULL);
+            if (sub_projection == NULL)
+                continue;
+            bool same_node = (target_partition.node(d) == node);
+            for (QHash<QString, Synapse*>::const_iterator s = sub_projection->synapses.constBegin(); s != sub_projection->synapses.constEnd(); ++s){
+                if (same_node)
+                    node_synapses[s.value()->unsplit_synapse]++;
+                else
+                    remote_synapses[s.value()->unsplit_synapse]++;
             }
-            split_time += timer.elapsed() - temp_time;
-            for(uint j=0; j<batch_sub_comps;j++)        //WRITE
+        }
+        for (int s=0; s<projection->synapses.values().size(); s++){
+            Synapse *synapse = projection->synapses.values()[s];
+            maxima.updateLevels(synapse, node_synapses.value(synapse, 0), remote_synapses.value(synapse, 0));
+        }
+    }
+
+    //sub inputs (to the neuron) by the node of their source sub population
+    for (int i=0; i<population->neuron->inputs.values().size(); i++){
+        Input *input = population->neuron->inputs.values()[i];
+        PopulationPartition src_partition = info_parser->getPartition(input->src);
+        QString src = "%1_%2_%3";
+        src = src.arg(input->src).arg(input->src_port).arg(input->dst_port);
+        uint node_inputs = 0;
+        uint remote_inputs = 0;
+        for (uint d=0; d<src_partition.count(); d++){
+            if (!sub_pop->neuron->inputs.contains(getSubName(src, d)))
+                continue;
+            if (src_partition.node(d) == node)
+                node_inputs++;
+            else
+                remote_inputs++;
+        }
+        maxima.updateLevels(input, node_inputs, remote_inputs);
+    }
+}
+
+void SpineMLSplitter::splitAndWritePopulations(const QVector<Population*> &populations, const QVector<Arena*> &arenas)
+{
+    //independent populations are split concurrently as tasks (each splitting its sub populations as tasks) so networks
+    //of many small populations use every core. Populations are started largest first (longest processing time first) so
+    //a large population is not left running alone at the end, and are written in document order.
+    uint count = populations.size();
+
+    //streamed populations are split one at a time (in parallel over sub populations) and written as they are split
+    if (streamed){
+        for (uint i=0; i<count; i++)
+            splitPopulation(populations[i]);
+        return;
+    }
+
+    QVector<Population*> sub_pops(count, NULL);
+    QVector<uint> sub_pop_counts(count, 0);
+    QVector<QPair<quint64, int> > order;
+    quint64 total_work = 0;
+    for (uint i=0; i<count; i++){
+        quint64 work = splitWork(populations[i]);
+        order.append(qMakePair(work, (int)i));
+        total_work += work;
+    }
+    std::sort(order.begin(), order.end());  //started from the back
+    bool parallel_split = parallel && (total_work >= SPLIT_SERIAL_GRAIN);
+
+    temp_time = timer.elapsed();
+    if (parallel_split)
+        omp_set_num_threads(omp_get_num_procs());
+    #pragma omp parallel if(parallel_split)
+    {
+        #pragma omp single
+        {
+            for (int k=count-1; k>=0; k--)
             {
-                uint sub_pop_index = j + (i*iCPU);
-                writer->writePopulation((Population*)&sub_pops[j], population);
-                if (!silent)
-                    qDebug() << "Written " << (&sub_pops[j])->neuron->name << " sub " << sub_pop_index;
+                int i = order[k].second;
+                #pragma omp task
+                {
+                    ArenaScope arena_scope(arenas[i]);
+                    PopulationPartition partition = info_parser->getPartition(populations[i]->neuron->name);
+                    sub_pop_counts[i] = partition.count();
+                    sub_pops[i] = new Population[sub_pop_counts[i]];
+                    bucketListConnections(populations[i]);
+                    splitSubPopulationTasks(populations[i], sub_pops[i], 0, sub_pop_counts[i], partition);
+                }
             }
-            delete [] sub_pops;
+        }
+    }
+    split_time += timer.elapsed() - temp_time;
+
+    //write in document order
+    for (uint i=0; i<count; i++){
+        writeSubPopulations(populations[i], sub_pops[i], sub_pop_counts[i]);
+        delete [] sub_pops[i];
+    }
+}
 
+quint64 SpineMLSplitter::splitWork(Population *population)
+{
+    //explicit connections dominate the split time of a population
+    quint64 work = population->neuron->size;
+    for (QHash<QString, Input*>::const_iterator i = population->neuron->inputs.constBegin(); i != population->neuron->inputs.constEnd(); ++i){
+        if (i.value()->remapping->Type() == LIST_CONNECTVITY_TYPE)
+            work += ((ConnectionList*)i.value()->remapping)->size();
+    }
+    for (QHash<QString, Projection*>::const_iterator p = population->projections.constBegin(); p != population->projections.constEnd(); ++p){
+        for (QHash<QString, Synapse*>::const_iterator s = p.value()->synapses.constBegin(); s != p.value()->synapses.constEnd(); ++s){
+            if (s.value()->connection->Type() == LIST_CONNECTVITY_TYPE)
+                work += ((ConnectionList*)s.value()->connection)->size();
         }
     }
-    else    //NON OPENMP
+    return work;
+}
+
+void SpineMLSplitter::countSplitMaxima(Population *population, const PopulationPartition &partition)
+{
+    //counts the sub synapses and sub inputs each sub population will have from the (bucketed) connectivity so sub
+    //populations can be written before the population is fully split
+    SplitMaxima maxima;
+    uint count = partition.count();
+    bool parallel_count = parallel && (count > 1) && (splitWork(population) >= SPLIT_SERIAL_GRAIN);
+
+    temp_time = timer.elapsed();
+    if (parallel_count)
+        omp_set_num_threads(omp_get_num_procs());
+    #pragma omp parallel if(parallel_count)
     {
-        for(uint i=0; i<num_src_sub_comps;i++)
-        {
-            temp_time = timer.elapsed();
+        SplitMaxima thread_maxima;
+        #pragma omp for schedule(dynamic)
+        for (int i=0; i<(int)count; i++)
+            countSubPopulationMaxima(population, i, partition, thread_maxima);
+        #pragma omp critical(split_maxima)
+        maxima.merge(thread_maxima);
+    }
+    maxima.reduce();
+    split_time += timer.elapsed() - temp_time;
+}
 
-            //SPLIT POPULATION
-            split_populations++;
-            Population *sub_pop = new Population();
-            sub_pop->neuron = new Neuron();
-            splitNeuron(population->neuron, sub_pop->neuron, i, num_src_sub_comps);
-            splitProjections(population, sub_pop, i);
-            split_time += timer.elapsed() - temp_time;
-            writer->writePopulation(sub_pop, population);   //OUTPUT sub population
-            delete sub_pop;             //CLEANUP
-            if (!silent)
-                qDebug() << "Split and Written " << population->neuron->name << " sub " << i;
+void SpineMLSplitter::countSubPopulationMaxima(Population *population, uint sub_pop_index, const PopulationPartition &partition, SplitMaxima &maxima)
+{
+    //mirrors splitProjections (errors are left to the split)
+    uint sub_pop_start = partition.start(sub_pop_index);
+    uint sub_pop_size = partition.size(sub_pop_index);
+    countSubInputMaxima(population->neuron, sub_pop_start, sub_pop_size, maxima);
+
+    for (QHash<QString, Projection*>::const_iterator p = population->projections.constBegin(); p != population->projections.constEnd(); ++p){
+        Projection *projection = p.value();
+        if (!info_parser->componentExists(projection->proj_population))
+            continue;
+        PopulationPartition target_partition = info_parser->getPartition(projection->proj_population);
+        uint target_sub_pop_count = target_partition.count();
+
+        for (QHash<QString, Synapse*>::const_iterator s = projection->synapses.constBegin(); s != projection->synapses.constEnd(); ++s){
+            Synapse *synapse = s.value();
+            switch(synapse->connection->Type()){
+                case(ALL_TO_ALL_CONNECTVITY_TYPE):
+                case(FIXED_PROBABILITY_CONNECTVITY_TYPE):{
+                    //materialised fixed probability sub synapses without connections are not written so this is an upper bound
+                    maxima.update(synapse, target_sub_pop_count);
+                    for (uint d=0; d<target_sub_pop_count; d++)
+                        countSubSynapseMaxima(synapse, sub_pop_start, sub_pop_size, target_partition.start(d), target_partition.size(d), maxima);
+                    break;
+                }
+                case(ONE_TO_ONE_CONNECTVITY_TYPE):{
+                    maxima.update(synapse, 1);
+                    countSubSynapseMaxima(synapse, sub_pop_start, sub_pop_size, sub_pop_start, sub_pop_size, maxima);
+                    break;
+                }
+                case(LIST_CONNECTVITY_TYPE):{
+                    //a sub synapse for each bucket of the sub population
+                    ConnectionList *connection_list = (ConnectionList*)synapse->connection;
+                    maxima.update(synapse, connection_list->bucketEnd(sub_pop_index) - connection_list->bucketStart(sub_pop_index));
+                    for (uint b=connection_list->bucketStart(sub_pop_index); b<connection_list->bucketEnd(sub_pop_index); b++){
+                        uint d = connection_list->bucket_cols[b];
+                        countSubSynapseMaxima(synapse, sub_pop_start, sub_pop_size, target_partition.start(d), target_partition.size(d), maxima);
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
         }
     }
 }
 
-void SpineMLSplitter::splitPopulationExplicit(Population *population, uint component_size)
+void SpineMLSplitter::countSubSynapseMaxima(Synapse *synapse, uint sub_pop_start, uint sub_pop_size, uint target_sub_pop_start, uint target_sub_pop_size, SplitMaxima &maxima)
 {
-    //cant write split projections or inputs until the maximum synapse split sizes have been calculated and stored in the unplit synapse!
-    uint num_src_sub_comps = UINT_DIV_CEIL(component_size, MAX_POPULATION_SIZE);
-    Population *sub_pops = new Population[num_src_sub_comps];
-
-    if(parallel){
-        temp_time = timer.elapsed();
-
-        //openmp threads
-        int iCPU = omp_get_num_procs();
-        omp_set_num_threads(iCPU);
+    //mirrors the inputs split by splitWeightUpdate and splitPostsynapse
+    countSubInputMaxima(synapse->weightupdate, 0, sub_pop_size*target_sub_pop_size, maxima);
+    if (info_parser->getSplitterMode() == SPLITMODE_PROJ_DEF_AT_SRC)
+        countSubInputMaxima(synapse->postsynapse, target_sub_pop_start, target_sub_pop_size, maxima);
+    else
+        countSubInputMaxima(synapse->postsynapse, sub_pop_start, sub_pop_size, maxima);
+}
 
-        uint batches = UINT_DIV_CEIL(num_src_sub_comps, iCPU);
-        for(uint i=0; i<batches; i++){
-            //number of sub components in batch
-            uint batch_sub_comps = iCPU;
-            if ((i+1) == batches){
-                batch_sub_comps = num_src_sub_comps % iCPU;
-                if (batch_sub_comps == 0)
-                    batch_sub_comps = iCPU;
+void SpineMLSplitter::countSubInputMaxima(Component *component, uint sub_comp_start, uint sub_comp_size, SplitMaxima &maxima)
+{
+    //mirrors splitInputs
+    for (QHash<QString, Input*>::const_iterator i = component->inputs.constBegin(); i != component->inputs.constEnd(); ++i){
+        Input *input = i.value();
+        PopulationPartition src_partition = info_parser->getPartition(input->src);
+        switch(input->remapping->Type()){
+            case(ONE_TO_ONE_CONNECTVITY_TYPE):{
+                maxima.update(input, 1);
+                break;
             }
-
-            #pragma omp parallel for
-            for(uint j=0; j<batch_sub_comps;j++)
-            {
-                //SPLIT
-                uint sub_pop_index = j + (i*iCPU);
-                #pragma omp atomic
-                ++split_populations;
-                Population *sub_pop = &sub_pops[sub_pop_index];
-                sub_pop->neuron = new Neuron();
-                splitNeuron(population->neuron, sub_pop->neuron, sub_pop_index, num_src_sub_comps);
-                splitProjections(population, sub_pop, sub_pop_index);
-                if (!silent)
-                    qDebug() << "Split " << population->neuron->name << " sub " << sub_pop_index;
+            case(ALL_TO_ALL_CONNECTVITY_TYPE):
+            case(FIXED_PROBABILITY_CONNECTVITY_TYPE):{
+                maxima.update(input, src_partition.count());
+                break;
             }
-            split_time += timer.elapsed() - temp_time;
-        }
-    }
-    else    //NON OPENMP
-    {
-        for(uint i=0; i<num_src_sub_comps;i++)
-        {
-            temp_time = timer.elapsed();
-
-            //SPLIT POPULATION
-            split_populations++;
-            Population *sub_pop = &sub_pops[i];
-            sub_pop->neuron = new Neuron();
-            splitNeuron(population->neuron, sub_pop->neuron, i, num_src_sub_comps);
-            splitProjections(population, sub_pop, i);
-            split_time += timer.elapsed() - temp_time;
-            if (!silent)
-                qDebug() << "Split " << population->neuron->name << " sub " << i;
+            case(LIST_CONNECTVITY_TYPE):{
+                //a sub input for each src sub component connected to the sub component
+                ConnectionList *connection_list = (ConnectionList*)input->remapping;
+                QVector<bool> src_connected(src_partition.count(), false);
+                uint sub_input_count = 0;
+                for (uint n=sub_comp_start; n<sub_comp_start+sub_comp_size; n++){
+                    for (uint c=connection_list->rowStart(n); c<connection_list->rowEnd(n); c++){
+                        uint d = src_partition.index(connection_list->cols[c]);
+                        if ((d < (uint)src_connected.size()) && (!src_connected[d])){
+                            src_connected[d] = true;
+                            sub_input_count++;
+                        }
+                    }
+                }
+                maxima.update(input, sub_input_count);
+                break;
+            }
+            default:
+                break;
         }
     }
-
-    //write
-    for(uint i=0; i<num_src_sub_comps;i++)
-    {
-        writer->writePopulation((Population*)&sub_pops[i], population);
-        if (!silent)
-            qDebug() << "Written " << (&sub_pops[i])->neuron->name << " sub " << i;
-    }
-    delete [] sub_pops;
 }
 
-
-void SpineMLSplitter::splitNeuron(Neuron *neuron, Neuron *sub_neuron, uint sub_pop_index, uint sub_pop_count)
+void SpineMLSplitter::splitNeuron(Neuron *neuron, Neuron *sub_neuron, uint sub_pop_index, const PopulationPartition &partition, SplitMaxima &maxima)
 {
     sub_neuron->name = getSubName(neuron->name, sub_pop_index);
     sub_neuron->definition_url = neuron->definition_url;
-    if (sub_pop_index==(sub_pop_count-1)){         //if last sub population then it may be a part population
-        uint remainder = neuron->size % MAX_POPULATION_SIZE;
-        if (remainder != 0)
-            sub_neuron->size = remainder;
-        else
-            sub_neuron->size = MAX_POPULATION_SIZE;
-    }else
-        sub_neuron->size = MAX_POPULATION_SIZE;
+    sub_neuron->size = partition.size(sub_pop_index);      //sub populations may differ in size (last or balanced sub populations)
     if(SPLITTER_DEBUG_OUTPUT)
         qDebug() << "Splitter: New Sub Population " << sub_neuron->name << " size=" << sub_neuron->size;
 
     //properties
-    splitProperties(neuron, sub_neuron, sub_pop_index, sub_neuron->size);
+    splitProperties(neuron, sub_neuron, partition.start(sub_pop_index), sub_neuron->size);
 
     //inputs
-    splitInputs(neuron, sub_neuron, sub_pop_index, sub_neuron->size);
+    splitInputs(neuron, sub_neuron, sub_pop_index, partition.start(sub_pop_index), sub_neuron->size, maxima);
 
 }
 
-void SpineMLSplitter::splitInputs(Component *component, Component *sub_component, uint sub_comp_index, uint sub_comp_size)
+void SpineMLSplitter::splitInputs(Component *component, Component *sub_component, uint sub_comp_index, uint sub_comp_start, uint sub_comp_size, SplitMaxima &maxima)
 {
     //inputs
     //TODO: input name is now src_x where x is the source sub index. This needs testing!!
     for (int i=0; i<component->inputs.values().size(); i++)
     {
         Input *input = component->inputs.values()[i];
-        ComponentInfo *comp_info = info_parser->getComponentInfo(input->src);  //cant be NULL as parse has checked this in parseInput function
+        PopulationPartition src_partition = info_parser->getPartition(input->src);
 
         switch(input->remapping->Type()){
             case(ONE_TO_ONE_CONNECTVITY_TYPE):{                //not supported for synapse or postsynapse (checked by parser)
+                if ((sub_comp_index >= src_partition.count()) || (src_partition.start(sub_comp_index) != sub_comp_start) || (src_partition.size(sub_comp_index) != sub_comp_size)){
+                    std::cerr << "Error: Partitions must be equal for one to one input from '" << input->src.toLocal8Bit().data() << "'." << std::endl;
+                    exit(0);
+                }
                 QString src = "%1_%2_%3";
                 src = src.arg(input->src).arg(input->src_port).arg(input->dst_port);
                 QString src_unique_name = getSubName(src, sub_comp_index);          //sub_comp_index == src_sub_index
                 QString src_sub_comp_name = getSubName(input->src, sub_comp_index); //sub_comp_index == src_sub_index
                 uint sub_input_index = 0;
                 getSubInput(input, sub_component, src_unique_name, src_sub_comp_name, sub_input_index);
-                input->sub_inp_max = 1;
+                maxima.update(input, 1);
                 break;
             }
             case(ALL_TO_ALL_CONNECTVITY_TYPE):
             case(FIXED_PROBABILITY_CONNECTVITY_TYPE):{
                 //sub input for each sub population/componenet
-                uint sub_inputs = UINT_DIV_CEIL(comp_info->size, MAX_POPULATION_SIZE);
+                uint sub_inputs = src_partition.count();
                 for (uint i=0; i< sub_inputs;i++){
                     QString src = "%1_%2_%3";
                     src = src.arg(input->src).arg(input->src_port).arg(input->dst_port);
@@ -408,63 +1194,14 @@ void SpineMLSplitter::splitInputs(Component *component, Component *sub_component
                     uint sub_input_index = i;
                     getSubInput(input, sub_component, src_unique_name, src_sub_comp_name, sub_input_index);
                 }
-                input->sub_inp_max = sub_inputs;
+                maxima.update(input, sub_inputs);
                 break;
             }
             case(LIST_CONNECTVITY_TYPE):{
-                ConnectionList *connection_list = (ConnectionList*)input->remapping;
-                uint sub_input_count = 0;
-
-                int max_comp_size = 0;                                              //maximum number of component indices for remapping destination
-                switch(component->Type()){
-                    case(COMPONENT_TYPE_POPULATION):
-                    case(COMPONENT_TYPE_POSTSYNAPSE):{
-                        max_comp_size = MAX_POPULATION_SIZE;
-                        break;
-                    }
-                    case(COMPONENT_TYPE_WEIGHT_UPDATE):{
-                        //not supported
-                        break;
-                    }
-                }
-
-                int dst_index_start = sub_comp_index*max_comp_size;
-                int dst_index_end = dst_index_start + sub_comp_size;
-                for (int n=dst_index_start; n<dst_index_end; n++){
-
-                    if (connection_list->connectionMatrix.contains(n)){
-                        QList <ConnectionInstance*> connections = connection_list->connectionMatrix[n].values();
-                        //check connection instances to see if this target is required for the sub projection
-                        for(int c=0;c<connections.size();c++)
-                        {
-                            ConnectionInstance *inst = connections[c];
-                            uint d = inst->src_neuron/MAX_POPULATION_SIZE;                  //sub componenent number of src neuron
-                            ConnectionInstance *sub_inst = new ConnectionInstance();
-                            sub_inst->delay = inst->delay;
-                            sub_inst->src_neuron = inst->src_neuron % MAX_POPULATION_SIZE;  //always resize in neuron space (as only comp inst and populations are valid src)
-                            sub_inst->dst_neuron = inst->dst_neuron % max_comp_size;        //resize by maximum comp size
-                            //get sub input (either existing or new)
-                            QString src = "%1_%2_%3";
-                            src = src.arg(input->src).arg(input->src_port).arg(input->dst_port);
-                            QString src_unique_name = getSubName(src, d);
-                            QString src_sub_comp_name = getSubName(input->src, d);
-                            Input *sub_input = getSubInput(input, sub_component, src_unique_name, src_sub_comp_name, sub_input_count);
-                            if (sub_input->remapping->Type() != LIST_CONNECTVITY_TYPE){ //should never happen!
-                                std::cerr << "Error: Sub input remapping type missmatch" << std::endl;
-                                exit(0);
-                            }
-                            ConnectionList *sub_connection_list = (ConnectionList*)sub_input->remapping;
-                            sub_inst->index = sub_connection_list->connectionIndices.values().size();                     //re-index
-                            sub_connection_list->connectionIndices[sub_inst->index] = sub_inst;
-                            sub_connection_list->connectionMatrix[sub_inst->dst_neuron].insertMulti(sub_inst->src_neuron, sub_inst);
-                        }
-                    }
-                }
-
-                //update max sub input count
-                if (sub_input_count > input->sub_inp_max){
-                    input->sub_inp_max = sub_input_count;
-                }
+                if (src_partition.uniform)
+                    splitListInput<true>(input, sub_component, sub_comp_start, sub_comp_size, src_partition, maxima);
+                else
+                    splitListInput<false>(input, sub_component, sub_comp_start, sub_comp_size, src_partition, maxima);
                 break;
             }
             case(NULL_CONNECTIVITY_TYPE):{
@@ -475,8 +1212,57 @@ void SpineMLSplitter::splitInputs(Component *component, Component *sub_component
 }
 
 
-void SpineMLSplitter::splitProjections(Population *population, Population *sub_pop, uint sub_pop_index)
+template <bool UNIFORM> void SpineMLSplitter::splitListInput(Input *input, Component *sub_component, uint sub_comp_start, uint sub_comp_size, const PopulationPartition &src_partition, SplitMaxima &maxima)
+{
+    //connections are bucketed by src sub component in one pass. Sub inputs are resolved by src sub component
+    //index so names are only formatted once per sub input rather than once per connection.
+    ConnectionList *connection_list = (ConnectionList*)input->remapping;
+    uint sub_input_count = 0;
+    QString src = "%1_%2_%3";
+    src = src.arg(input->src).arg(input->src_port).arg(input->dst_port);
+    QVector<ConnectionList*> src_sub_lists(src_partition.count(), NULL);   //sub input list by src sub component
+    QList<ConnectionList*> sub_connection_lists;
+
+    //rows of input remappings are dst (component) neurons (weight update inputs are not supported)
+    uint dst_index_start = sub_comp_start;
+    uint dst_index_end = dst_index_start + sub_comp_size;
+    for (uint n=dst_index_start; n<dst_index_end; n++){
+        for (uint c=connection_list->rowStart(n); c<connection_list->rowEnd(n); c++)
+        {
+            uint src_neuron = connection_list->cols[c];
+            uint d = src_partition.index<UNIFORM>(src_neuron);                 //sub componenent number of src neuron
+            if (d >= (uint)src_sub_lists.size()){
+                std::cerr << "Error: Input connection from neuron " << src_neuron << " is outside of source '" << input->src.toLocal8Bit().data() << "'." << std::endl;
+                exit(0);
+            }
+            ConnectionList *sub_connection_list = src_sub_lists[d];
+            if (sub_connection_list == NULL){
+                //get sub input (either existing or new)
+                Input *sub_input = getSubInput(input, sub_component, getSubName(src, d), getSubName(input->src, d), sub_input_count);
+                if (sub_input->remapping->Type() != LIST_CONNECTVITY_TYPE){ //should never happen!
+                    std::cerr << "Error: Sub input remapping type missmatch" << std::endl;
+                    exit(0);
+                }
+                sub_connection_list = (ConnectionList*)sub_input->remapping;
+                src_sub_lists[d] = sub_connection_list;
+                sub_connection_lists.append(sub_connection_list);
+            }
+            //always resize src in neuron space (as only comp inst and populations are valid src), resize dst by maximum comp size
+            sub_connection_list->appendConnection(n - dst_index_start, src_neuron - src_partition.start(d), connection_list->delays[c], 0);
+        }
+    }
+    //re-index (rows and columns are appended in order so no sorting is required)
+    for (int l=0; l<sub_connection_lists.size(); l++)
+        sub_connection_lists[l]->compress(true);
+
+    //update max sub input count
+    maxima.update(input, sub_input_count);
+}
+
+void SpineMLSplitter::splitProjections(Population *population, Population *sub_pop, uint sub_pop_index, SplitMaxima &maxima)
 {
+    PopulationPartition partition = info_parser->getPartition(population->neuron->name);
+    SplitterMode splitter_mode = info_parser->getSplitterMode();
     for (int p=0;p<population->projections.values().size();p++){
         Projection *projection = population->projections.values()[p];
 
@@ -493,209 +1279,202 @@ void SpineMLSplitter::splitProjections(Population *population, Population *sub_p
         }
         PopulationInfo * target_pop_info = (PopulationInfo*)target_info;
 
-        //target is the named src or dst of the projection
-        uint target_pop_size = target_pop_info->size;
-        uint target_sub_pop_count = UINT_DIV_CEIL(target_pop_info->size, MAX_POPULATION_SIZE);
-
         for (int c=0;c<projection->synapses.values().size();c++)
         {
             Synapse* synapse = projection->synapses.values()[c];
-            switch(synapse->connection->Type())
+            if (splitter_mode == SPLITMODE_PROJ_DEF_AT_SRC)
+                splitSynapse<SPLITMODE_PROJ_DEF_AT_SRC>(population, sub_pop, sub_pop_index, partition, projection, synapse, target_pop_info, maxima);
+            else
+                splitSynapse<SPLITMODE_PROJ_DEF_AT_DST>(population, sub_pop, sub_pop_index, partition, projection, synapse, target_pop_info, maxima);
+        }
+    }
+}
+
+template <SplitterMode MODE> void SpineMLSplitter::splitSynapse(Population *population, Population *sub_pop, uint sub_pop_index, const PopulationPartition &partition, Projection *projection, Synapse *synapse, PopulationInfo *target_pop_info, SplitMaxima &maxima)
+{
+    uint sub_pop_start = partition.start(sub_pop_index);
+
+    //target is the named src or dst of the projection
+    uint target_pop_size = target_pop_info->size;
+    const PopulationPartition &target_partition = target_pop_info->partition;
+    uint target_sub_pop_count = target_partition.count();
+
+    switch(synapse->connection->Type())
+    {
+        case(ALL_TO_ALL_CONNECTVITY_TYPE):
+        {
+            //projection required for each target sub population
+            for(uint d=0;d<target_sub_pop_count; d++)
             {
-                case(ALL_TO_ALL_CONNECTVITY_TYPE):
-                {
-                    //projection required for each target sub population
-                    for(uint d=0;d<target_sub_pop_count; d++)
-                    {
-                        AllToAllConnection *all_to_all = (AllToAllConnection*)synapse->connection;
-                        QString taregt_sub_pop_name = getSubName(projection->proj_population, d);
-                        uint target_sub_pop_size = MAX_POPULATION_SIZE;
-                        if (d == (target_sub_pop_count-1)){
-                            uint r = target_pop_size % MAX_POPULATION_SIZE;
-                            if (r != 0)
-                                target_sub_pop_size = r;
-                        }
-                        Projection *sub_proj = getSubProjection(sub_pop, taregt_sub_pop_name);
-                        Synapse *sub_synapse = new Synapse();
-                        sub_synapse->unsplit_synapse = synapse;
-                        sub_synapse->_sub_syn_index = d;
-
-                        AllToAllConnection *sub_all_to_all = new AllToAllConnection();
-                        sub_all_to_all->delay = cloneDelayPropertyValue(all_to_all->delay);
-                        sub_synapse->connection = (AbstractionConnection*) sub_all_to_all;
-                        splitWeightUpdate(synapse, sub_synapse, sub_pop_index, sub_pop->neuron->size, population->neuron->size, d, target_sub_pop_size, target_pop_size);
-                        splitPostsynapse(synapse, sub_synapse, sub_pop_index, sub_pop->neuron->size, d, target_sub_pop_size);
-                        sub_proj->synapses[sub_synapse->weightupdate->name] = sub_synapse;
-                        if (SPLITTER_DEBUG_OUTPUT)
-                            qDebug() << "Splitter: New Synapse (with all to all connection) added to Sub Projection (" << sub_pop->neuron->name << "->"<< taregt_sub_pop_name <<")";
-                    }
-                    synapse->_sub_syn_max = target_sub_pop_count;
-                    break;
-                }
-                case(ONE_TO_ONE_CONNECTVITY_TYPE):
-                {
-                    OneToOneConnection *one_to_one = (OneToOneConnection*)synapse->connection;
-                    //Check dimensionality of populatoins to make sure they can be connected
-                    if (target_pop_size != population->neuron->size){
-                        std::cerr << "Error: Population sizes must be equal in synapse with one to one connection between '" << population->neuron->name.toLocal8Bit().data() << "' and '" << projection->proj_population.toLocal8Bit().data() << "'." << std::endl;
-                        exit(0);
-                    }
-                    //single projection required between sub populations
-                    QString target_sub_pop_name = getSubName(projection->proj_population, sub_pop_index);
-                    Projection *sub_proj = getSubProjection(sub_pop, target_sub_pop_name);
-                    Synapse *sub_synapse = new Synapse();
-                    sub_synapse->unsplit_synapse = synapse;
-                    sub_synapse->_sub_syn_index = 0;
-                    synapse->_sub_syn_max = 1;
-
-                    OneToOneConnection *sub_one_to_one = new OneToOneConnection();
-                    sub_one_to_one->delay = cloneDelayPropertyValue(one_to_one->delay);
-                    sub_synapse->connection = (AbstractionConnection*) sub_one_to_one;
-                    splitWeightUpdate(synapse, sub_synapse, sub_pop_index, sub_pop->neuron->size, population->neuron->size, sub_pop_index, sub_pop->neuron->size, target_pop_size); //sub_pop_size = target_sub_pop_size
-                    splitPostsynapse(synapse, sub_synapse, sub_pop_index, sub_pop->neuron->size, sub_pop_index, sub_pop->neuron->size);
-                    sub_proj->synapses[sub_synapse->weightupdate->name] = sub_synapse;
-                    if (SPLITTER_DEBUG_OUTPUT)
-                        qDebug() << "Splitter: New Synapse (with one to one connection) added to Sub Projection (" << sub_pop->neuron->name << "->"<< target_sub_pop_name <<")";
+                AllToAllConnection *all_to_all = (AllToAllConnection*)synapse->connection;
+                QString taregt_sub_pop_name = getSubName(projection->proj_population, d);
+                uint target_sub_pop_size = target_partition.size(d);
+                Projection *sub_proj = getSubProjection(sub_pop, taregt_sub_pop_name);
+                Synapse *sub_synapse = new Synapse();
+                sub_synapse->unsplit_synapse = synapse;
+                sub_synapse->_sub_syn_index = d;
 
-                    break;
-                }
-                case(LIST_CONNECTVITY_TYPE):
-                {
-                    //check connectivity instances list and make projection accordingly
-                    ConnectionList *connection_list = (ConnectionList*)synapse->connection;
-                    uint sub_pop_index_start = sub_pop_index*MAX_POPULATION_SIZE;
-                    uint sub_pop_index_end = sub_pop_index_start + sub_pop->neuron->size;
-
-                    uint sub_synapse_count = 0;
-                    for(uint n=sub_pop_index_start;n<sub_pop_index_end;n++)
-                    {
-                        //if source neuron has projections to other neurons in dst pop
-                        if (connection_list->connectionMatrix.contains(n))
-                        {
-                            QList <ConnectionInstance*> connections = connection_list->connectionMatrix[n].values();
-                            //check connection instances to see if this target is required for the sub projection
-                            for(int c=0;c<connections.size();c++)
-                            {
-                                ConnectionInstance *inst = connections[c];
-                                uint d = inst->dst_neuron/MAX_POPULATION_SIZE;          //sub population number of dst neuron
-                                ConnectionInstance *sub_inst = new ConnectionInstance();
-                                sub_inst->delay = inst->delay;
-                                sub_inst->src_neuron = inst->src_neuron % MAX_POPULATION_SIZE;;
-                                sub_inst->dst_neuron = inst->dst_neuron % MAX_POPULATION_SIZE;
-
-                                QString target_sub_pop_name = getSubName(projection->proj_population, d);
-                                Projection *sub_proj = getSubProjection(sub_pop, target_sub_pop_name);
-
-                                //if synapse is not already within the projection then add it
-                                QString sub_wu_name = "%1_sub%2_%3";
-                                sub_wu_name = sub_wu_name.arg(synapse->weightupdate->name).arg(sub_pop_index).arg(d);
-                                Synapse * sub_synapse = NULL;
-                                if (sub_proj->synapses.contains(sub_wu_name)){
-                                    sub_synapse = sub_proj->synapses[sub_wu_name];
-                                }else{
-                                    //new synapse! split wu and ps later (requires all sub connectivity to be calculated first)
-                                    sub_synapse = new Synapse();
-                                    sub_synapse->unsplit_synapse = synapse;
-                                    sub_synapse->_sub_syn_index = sub_synapse_count++;
-                                    sub_synapse->_sub_target_index = d;
-                                    ConnectionList *sub_connection_list = new ConnectionList();
-                                    sub_synapse->connection = (AbstractionConnection*) sub_connection_list;
-                                    sub_connection_list->delay = cloneDelayPropertyValue(connection_list->delay);
-                                    sub_proj->synapses[sub_wu_name] = sub_synapse; //update hash map
-                                    if (SPLITTER_DEBUG_OUTPUT)
-                                        qDebug() << "Splitter: New Synapse (with list connection) added to Sub Projection (" << sub_pop->neuron->name << "->"<< target_sub_pop_name <<")";
-                                }
-                                ConnectionList *sub_connection_list = (ConnectionList*)(sub_synapse->connection);
-                                sub_inst->index = sub_connection_list->connectionIndices.values().size();
-                                sub_connection_list->connectionIndices[sub_inst->index] = sub_inst;
-                                if (sub_connection_list->connectionMatrix[sub_inst->src_neuron].contains(sub_inst->dst_neuron)){
-                                    std::cerr << "Error: duplicate connection found from " << sub_pop->neuron->name.toLocal8Bit().data() << " index " << sub_inst->src_neuron << " to " << target_sub_pop_name.toLocal8Bit().data() << " index " << sub_inst->dst_neuron << std::endl;
-                                    break;
-                                }
-                                sub_connection_list->connectionMatrix[sub_inst->src_neuron][sub_inst->dst_neuron] = sub_inst;
-                                if (SPLITTER_DEBUG_OUTPUT)
-                                    qDebug() << "Splitter: New Connection Instance from " << sub_pop->neuron->name << " index " << sub_inst->src_neuron << " to " << target_sub_pop_name << " index " << sub_inst->dst_neuron;
-                            }
+                AllToAllConnection *sub_all_to_all = new AllToAllConnection();
+                sub_all_to_all->delay = cloneDelayPropertyValue(all_to_all->delay);
+                sub_synapse->connection = (AbstractionConnection*) sub_all_to_all;
+                splitWeightUpdate<MODE>(synapse, sub_synapse, sub_pop_index, sub_pop_start, sub_pop->neuron->size, population->neuron->size, d, target_partition.start(d), target_sub_pop_size, target_pop_size, maxima);
+                splitPostsynapse<MODE>(synapse, sub_synapse, sub_pop_index, sub_pop_start, sub_pop->neuron->size, d, target_partition.start(d), target_sub_pop_size, maxima);
+                sub_proj->synapses[sub_synapse->weightupdate->name] = sub_synapse;
+                if (SPLITTER_DEBUG_OUTPUT)
+                    qDebug() << "Splitter: New Synapse (with all to all connection) added to Sub Projection (" << sub_pop->neuron->name << "->"<< taregt_sub_pop_name <<")";
+            }
+            maxima.update(synapse, target_sub_pop_count);
+            break;
+        }
+        case(ONE_TO_ONE_CONNECTVITY_TYPE):
+        {
+            OneToOneConnection *one_to_one = (OneToOneConnection*)synapse->connection;
+            //Check dimensionality of populatoins to make sure they can be connected
+            if (target_pop_size != population->neuron->size){
+                std::cerr << "Error: Population sizes must be equal in synapse with one to one connection between '" << population->neuron->name.toLocal8Bit().data() << "' and '" << projection->proj_population.toLocal8Bit().data() << "'." << std::endl;
+                exit(0);
+            }
+            if (target_partition.offsets != partition.offsets){
+                std::cerr << "Error: Partitions must be equal in synapse with one to one connection between '" << population->neuron->name.toLocal8Bit().data() << "' and '" << projection->proj_population.toLocal8Bit().data() << "'." << std::endl;
+                exit(0);
+            }
+            //single projection required between sub populations
+            QString target_sub_pop_name = getSubName(projection->proj_population, sub_pop_index);
+            Projection *sub_proj = getSubProjection(sub_pop, target_sub_pop_name);
+            Synapse *sub_synapse = new Synapse();
+            sub_synapse->unsplit_synapse = synapse;
+            sub_synapse->_sub_syn_index = 0;
+            maxima.update(synapse, 1);
+
+            OneToOneConnection *sub_one_to_one = new OneToOneConnection();
+            sub_one_to_one->delay = cloneDelayPropertyValue(one_to_one->delay);
+            sub_synapse->connection = (AbstractionConnection*) sub_one_to_one;
+            splitWeightUpdate<MODE>(synapse, sub_synapse, sub_pop_index, sub_pop_start, sub_pop->neuron->size, population->neuron->size, sub_pop_index, sub_pop_start, sub_pop->neuron->size, target_pop_size, maxima); //sub_pop_size = target_sub_pop_size
+            splitPostsynapse<MODE>(synapse, sub_synapse, sub_pop_index, sub_pop_start, sub_pop->neuron->size, sub_pop_index, sub_pop_start, sub_pop->neuron->size, maxima);
+            sub_proj->synapses[sub_synapse->weightupdate->name] = sub_synapse;
+            if (SPLITTER_DEBUG_OUTPUT)
+                qDebug() << "Splitter: New Synapse (with one to one connection) added to Sub Projection (" << sub_pop->neuron->name << "->"<< target_sub_pop_name <<")";
 
-                        }
-                    }
+            break;
+        }
+        case(LIST_CONNECTVITY_TYPE):
+        {
+            //connections are bucketed by (src sub pop, dst sub pop) before splitting so each bucket is a sub synapse
+            ConnectionList *connection_list = (ConnectionList*)synapse->connection;
 
-                    //split WeightUpdate and PostSynapse
-                    for (int p=0; p<sub_pop->projections.values().size(); p++){
-                        Projection* sub_proj = sub_pop->projections.values().at(p);
-                        for (int s=0; s<sub_proj->synapses.values().size(); s++){
-                            Synapse* sub_synapse = sub_proj->synapses.values().at(s);
-                            //get sub pop index of target
-                            int d = sub_synapse->_sub_target_index;
-
-                            //calculate target sub population size
-                            uint target_sub_pop_size = MAX_POPULATION_SIZE;
-                            if (d == static_cast<int>((target_sub_pop_count-1))){
-                                uint r = target_pop_size % MAX_POPULATION_SIZE;
-                                if (r != 0)
-                                    target_sub_pop_size = r;
-                            }
+            uint sub_synapse_count = 0;
+            QList<Synapse*> sub_synapses;
+            for(uint b=connection_list->bucketStart(sub_pop_index);b<connection_list->bucketEnd(sub_pop_index);b++)
+            {
+                uint d = connection_list->bucket_cols[b];          //sub population number of dst neurons
+                QString target_sub_pop_name = getSubName(projection->proj_population, d);
+                Projection *sub_proj = getSubProjection(sub_pop, target_sub_pop_name);
+
+                //new synapse! split wu and ps later (requires all sub connectivity to be calculated first)
+                QString sub_wu_name = "%1_sub%2_%3";
+                sub_wu_name = sub_wu_name.arg(synapse->weightupdate->name).arg(sub_pop_index).arg(d);
+                Synapse *sub_synapse = new Synapse();
+                sub_synapse->unsplit_synapse = synapse;
+                sub_synapse->_sub_syn_index = sub_synapse_count++;
+                sub_synapse->_sub_target_index = d;
+                ConnectionList *sub_connection_list = new ConnectionList();
+                sub_synapse->connection = (AbstractionConnection*) sub_connection_list;
+                sub_connection_list->delay = cloneDelayPropertyValue(connection_list->delay);
+                sub_proj->synapses[sub_wu_name] = sub_synapse; //update hash map
+                sub_synapses.append(sub_synapse);
+                if (SPLITTER_DEBUG_OUTPUT)
+                    qDebug() << "Splitter: New Synapse (with list connection) added to Sub Projection (" << sub_pop->neuron->name << "->"<< target_sub_pop_name <<")";
+
+                //bucket connections are ordered by src then dst neuron
+                uint bucket_start = connection_list->bucket_offsets[b];
+                uint bucket_end = connection_list->bucket_offsets[b+1];
+                uint target_sub_pop_start = target_partition.start(d);
+                sub_connection_list->reserve(bucket_end - bucket_start);
+                sub_connection_list->parent_indices.reserve(bucket_end - bucket_start);
+                for(uint k=bucket_start;k<bucket_end;k++)
+                {
+                    uint c = connection_list->bucket_positions[k];
+                    sub_connection_list->appendConnection(connection_list->bucket_rows[k] - sub_pop_start, connection_list->cols[c] - target_sub_pop_start, connection_list->delays[c], 0);
+                    sub_connection_list->parent_indices.append(connection_list->indices[c]);
+                }
 
-                            splitWeightUpdate(synapse, sub_synapse, sub_pop_index, sub_pop->neuron->size, population->neuron->size, d, target_sub_pop_size, target_pop_size);
-                            splitPostsynapse(synapse, sub_synapse, sub_pop_index, sub_pop->neuron->size, d, target_sub_pop_size);
+                //re-index sub connection list (rows are appended in order so no sorting is required)
+                if (!sub_connection_list->compress(true))
+                    std::cerr << "Error: duplicate connection found from " << sub_pop->neuron->name.toLocal8Bit().data() << " in sub synapse of " << synapse->weightupdate->name.toLocal8Bit().data() << std::endl;
+            }
 
-                        }
-                    }
+            //split WeightUpdate and PostSynapse of the new sub synapses
+            for (int s=0; s<sub_synapses.size(); s++){
+                Synapse* sub_synapse = sub_synapses[s];
+                //get sub pop index of target
+                int d = sub_synapse->_sub_target_index;
 
+                //calculate target sub population size
+                uint target_sub_pop_size = target_partition.size(d);
 
-                    //update the maximum sub synapse count for the unsplit synapse
-                    if (sub_synapse_count > synapse->_sub_syn_max){
-                        //qDebug() <<  "NEW MAX SUB SYN" << sub_synapse_count;
-                        synapse->_sub_syn_max = sub_synapse_count;
-                    }
+                splitWeightUpdate<MODE>(synapse, sub_synapse, sub_pop_index, sub_pop_start, sub_pop->neuron->size, population->neuron->size, d, target_partition.start(d), target_sub_pop_size, target_pop_size, maxima);
+                splitPostsynapse<MODE>(synapse, sub_synapse, sub_pop_index, sub_pop_start, sub_pop->neuron->size, d, target_partition.start(d), target_sub_pop_size, maxima);
+            }
 
-                    break;
-                }
-                case(FIXED_PROBABILITY_CONNECTVITY_TYPE):
-                {
-                    FixedProbabilityConnection *fixed_prob_conn = (FixedProbabilityConnection*) synapse->connection;
-                    //projection required for each dst sub population
-                    for(uint d=0;d<target_sub_pop_count; d++)
-                    {
-                        QString target_sub_pop_name = getSubName(projection->proj_population, d);
-                        //dst sub pop size
-                        uint target_sub_pop_size = MAX_POPULATION_SIZE;
-                        if (d == (target_sub_pop_count-1)){
-                            uint r = target_pop_size % MAX_POPULATION_SIZE;
-                            if (r != 0)
-                                target_sub_pop_size = r;
-                        }
-                        Projection *sub_proj = getSubProjection(sub_pop, target_sub_pop_name);
-                        Synapse *sub_synapse = new Synapse();
-                        sub_synapse->unsplit_synapse = synapse;
-                        sub_synapse->_sub_syn_index = d;
-
-                        FixedProbabilityConnection *sub_fixed_prob_conn = new FixedProbabilityConnection();
-                        sub_fixed_prob_conn->seed = fixed_prob_conn->seed;
-                        sub_fixed_prob_conn->probability = fixed_prob_conn->probability;
-                        sub_fixed_prob_conn->delay = cloneDelayPropertyValue(fixed_prob_conn->delay);
-                        sub_synapse->connection = (AbstractionConnection*)sub_fixed_prob_conn;
-                        splitWeightUpdate(synapse, sub_synapse, sub_pop_index, sub_pop->neuron->size, population->neuron->size, d, target_sub_pop_size, target_pop_size);
-                        splitPostsynapse(synapse, sub_synapse, sub_pop_index, sub_pop->neuron->size, d, target_sub_pop_size);
-                        sub_proj->synapses[sub_synapse->weightupdate->name] = sub_synapse;
-                        if (SPLITTER_DEBUG_OUTPUT)
-                            qDebug() << "Splitter: New Synapse (with fixed probability connection) added to Sub Projection (" << sub_pop->neuron->name << "->"<< target_sub_pop_name <<")";
+            //update the maximum sub synapse count for the unsplit synapse
+            maxima.update(synapse, sub_synapse_count);
+
+            break;
+        }
+        case(FIXED_PROBABILITY_CONNECTVITY_TYPE):
+        {
+            FixedProbabilityConnection *fixed_prob_conn = (FixedProbabilityConnection*) synapse->connection;
+            bool local_is_src = (MODE != SPLITMODE_PROJ_DEF_AT_DST);
+            uint sub_synapse_count = 0;
+            //projection required for each dst sub population (unless materialised and no connections are generated)
+            for(uint d=0;d<target_sub_pop_count; d++)
+            {
+                QString target_sub_pop_name = getSubName(projection->proj_population, d);
+                //dst sub pop size
+                uint target_sub_pop_size = target_partition.size(d);
+
+                AbstractionConnection *sub_connection;
+                if (materialise_fixed_probability){
+                    ConnectionList *sub_connection_list = materialiseFixedProbability(fixed_prob_conn, local_is_src, sub_pop_start, sub_pop->neuron->size, target_partition.start(d), target_sub_pop_size);
+                    if (sub_connection_list->size() == 0){
+                        delete sub_connection_list;
+                        continue;
                     }
-                    synapse->_sub_syn_max = target_sub_pop_count;
-                    break;
-                }
-                default:
-                {
-                    std::cerr << "Error: Synapse connection type not supported in population named" << population->neuron->name.toLocal8Bit().data() << std::endl;
-                    break;
+                    sub_connection = (AbstractionConnection*)sub_connection_list;
+                }else{
+                    FixedProbabilityConnection *sub_fixed_prob_conn = new FixedProbabilityConnection();
+                    sub_fixed_prob_conn->seed = fixed_prob_conn->seed;
+                    sub_fixed_prob_conn->probability = fixed_prob_conn->probability;
+                    sub_fixed_prob_conn->delay = cloneDelayPropertyValue(fixed_prob_conn->delay);
+                    sub_connection = (AbstractionConnection*)sub_fixed_prob_conn;
                 }
+
+                Projection *sub_proj = getSubProjection(sub_pop, target_sub_pop_name);
+                Synapse *sub_synapse = new Synapse();
+                sub_synapse->unsplit_synapse = synapse;
+                sub_synapse->_sub_syn_index = materialise_fixed_probability ? sub_synapse_count : d;
+                sub_synapse->_sub_target_index = d;
+                sub_synapse->connection = sub_connection;
+                sub_synapse_count++;
+                splitWeightUpdate<MODE>(synapse, sub_synapse, sub_pop_index, sub_pop_start, sub_pop->neuron->size, population->neuron->size, d, target_partition.start(d), target_sub_pop_size, target_pop_size, maxima);
+                splitPostsynapse<MODE>(synapse, sub_synapse, sub_pop_index, sub_pop_start, sub_pop->neuron->size, d, target_partition.start(d), target_sub_pop_size, maxima);
+                sub_proj->synapses[sub_synapse->weightupdate->name] = sub_synapse;
+                if (SPLITTER_DEBUG_OUTPUT)
+                    qDebug() << "Splitter: New Synapse (with fixed probability connection) added to Sub Projection (" << sub_pop->neuron->name << "->"<< target_sub_pop_name <<")";
             }
+            maxima.update(synapse, sub_synapse_count);
+            break;
+        }
+        default:
+        {
+            std::cerr << "Error: Synapse connection type not supported in population named" << population->neuron->name.toLocal8Bit().data() << std::endl;
+            break;
         }
     }
 }
 
 
-void SpineMLSplitter::splitWeightUpdate(Synapse *synapse, Synapse *sub_synapse, uint sub_pop_index, uint sub_pop_size, uint pop_size, uint target_sub_pop_index, uint target_sub_pop_size, uint target_pop_size)
+template <SplitterMode MODE> void SpineMLSplitter::splitWeightUpdate(Synapse *synapse, Synapse *sub_synapse, uint sub_pop_index, uint sub_pop_start, uint sub_pop_size, uint pop_size, uint target_sub_pop_index, uint target_sub_pop_start, uint target_sub_pop_size, uint target_pop_size, SplitMaxima &maxima)
 {
     sub_synapse->weightupdate = new WeightUpdate();
     QString name = "%1_sub%2_%3";
@@ -707,21 +1486,21 @@ void SpineMLSplitter::splitWeightUpdate(Synapse *synapse, Synapse *sub_synapse,
     sub_synapse->weightupdate->target_connectivity = sub_synapse->connection;
 
     //properties and inputs
-    if (info_parser->getSplitterMode() == SPLITMODE_PROJ_DEF_AT_SRC){
-        splitProperties(synapse->weightupdate, sub_synapse->weightupdate, sub_pop_index, sub_pop_size, target_sub_pop_index, target_sub_pop_size, target_pop_size);
+    if (MODE == SPLITMODE_PROJ_DEF_AT_SRC){
+        splitProperties(synapse->weightupdate, sub_synapse->weightupdate, sub_pop_start, sub_pop_size, target_sub_pop_start, target_sub_pop_size, target_pop_size);
         //no support for inputs for weight updates
     }
     else{
-        splitProperties(synapse->weightupdate, sub_synapse->weightupdate, target_sub_pop_index, target_sub_pop_size, sub_pop_index, sub_pop_size, pop_size);
+        splitProperties(synapse->weightupdate, sub_synapse->weightupdate, target_sub_pop_start, target_sub_pop_size, sub_pop_start, sub_pop_size, pop_size);
         //no upport for inputs for weight updates
     }
 
     //inputs
-    splitInputs(synapse->weightupdate, sub_synapse->weightupdate, sub_pop_index, sub_pop_size*target_sub_pop_size);
+    splitInputs(synapse->weightupdate, sub_synapse->weightupdate, sub_pop_index, 0, sub_pop_size*target_sub_pop_size, maxima);
 
 }
 
-void SpineMLSplitter::splitPostsynapse(Synapse *synapse, Synapse *sub_synapse, uint sub_pop_index, uint sub_pop_size, uint target_sub_pop_index, uint target_sub_pop_size)
+template <SplitterMode MODE> void SpineMLSplitter::splitPostsynapse(Synapse *synapse, Synapse *sub_synapse, uint sub_pop_index, uint sub_pop_start, uint sub_pop_size, uint target_sub_pop_index, uint target_sub_pop_start, uint target_sub_pop_size, SplitMaxima &maxima)
 {
     sub_synapse->postsynapse = new Postsynapse();
     QString name = "%1_sub%2_%3";
@@ -734,17 +1513,17 @@ void SpineMLSplitter::splitPostsynapse(Synapse *synapse, Synapse *sub_synapse, u
     sub_synapse->postsynapse->output_dst_port = synapse->postsynapse->output_dst_port;
 
     //properties (swap target and sub pop indices and sized for projections specified at dst)
-    if (info_parser->getSplitterMode() == SPLITMODE_PROJ_DEF_AT_SRC){
-        splitProperties(synapse->postsynapse, sub_synapse->postsynapse, sub_pop_index, sub_pop_size, target_sub_pop_index, target_sub_pop_size); //no sub_comp_size required
-        splitInputs(synapse->postsynapse, sub_synapse->postsynapse, target_sub_pop_index, target_sub_pop_size); //TODO TEST
+    if (MODE == SPLITMODE_PROJ_DEF_AT_SRC){
+        splitProperties(synapse->postsynapse, sub_synapse->postsynapse, sub_pop_start, sub_pop_size, target_sub_pop_start, target_sub_pop_size); //no sub_comp_size required
+        splitInputs(synapse->postsynapse, sub_synapse->postsynapse, target_sub_pop_index, target_sub_pop_start, target_sub_pop_size, maxima); //TODO TEST
     }
     else{
-        splitProperties(synapse->postsynapse, sub_synapse->postsynapse, target_sub_pop_index, target_sub_pop_size, sub_pop_index, sub_pop_size); //reverse src and dst
-        splitInputs(synapse->postsynapse, sub_synapse->postsynapse, sub_pop_index, sub_pop_size); //TODO:TEST
+        splitProperties(synapse->postsynapse, sub_synapse->postsynapse, target_sub_pop_start, target_sub_pop_size, sub_pop_start, sub_pop_size); //reverse src and dst
+        splitInputs(synapse->postsynapse, sub_synapse->postsynapse, sub_pop_index, sub_pop_start, sub_pop_size, maxima); //TODO:TEST
     }
 }
 
-void SpineMLSplitter::splitProperties(Component *component, Component *sub_component, uint sub_comp_index, uint sub_comp_size, uint target_sub_pop_index, uint target_sub_pop_size, uint target_pop_size)
+void SpineMLSplitter::splitProperties(Component *component, Component *sub_component, uint sub_comp_start, uint sub_comp_size, uint target_sub_pop_start, uint target_sub_pop_size, uint target_pop_size)
 {
     //properties
     for (int i=0; i< component->properties.size(); i++)
@@ -754,6 +1533,19 @@ void SpineMLSplitter::splitProperties(Component *component, Component *sub_compo
         sub_prop->name = property->name;
         sub_prop->dimension = property->dimension;
 
+        //sample stochastic values for each instance of the sub component
+        if (sampled_properties && PropertySampler::isStochastic(property->value)){
+            PropertyValueList *sub_prop_value = sampleProperty(property->value, component, sub_component, sub_comp_start, sub_comp_size, target_sub_pop_start, target_sub_pop_size, target_pop_size);
+            if (sub_prop_value != NULL){
+                sub_prop->value = (PropertyValue*)sub_prop_value;
+                if (sub_prop_value->count() > 0)
+                    sub_component->properties.append(sub_prop);
+                else
+                    delete sub_prop;
+                continue;
+            }
+        }
+
         //switch property type and either add the property or make sure it is deleted if not needed
         switch(property->value->Type()){
             case(FIXED_VALUE_TYPE):
@@ -772,17 +1564,7 @@ void SpineMLSplitter::splitProperties(Component *component, Component *sub_compo
                 //Switch by component type
                 switch(component->Type()){
                     case(COMPONENT_TYPE_POPULATION):{
-                        uint start_index = sub_comp_index*MAX_POPULATION_SIZE;
-                        for (uint j=start_index;j<start_index+sub_comp_size;j++)
-                        {
-                            if (property_value->valueInstances.contains(j)){
-                                PropertyValueInstance* prop_inst = property_value->valueInstances[j];
-                                PropertyValueInstance* sub_prop_inst = new PropertyValueInstance();
-                                sub_prop_inst->index = prop_inst->index % MAX_POPULATION_SIZE;          //remap to sub neuron
-                                sub_prop_inst->value = prop_inst->value;
-                                sub_prop_value->valueInstances[sub_prop_inst->index] = sub_prop_inst;
-                            }
-                        }
+                        sub_prop_value->appendRange(property_value, sub_comp_start, sub_comp_size, 0);   //remap to sub neuron
                         break;
                     }
                     case(COMPONENT_TYPE_WEIGHT_UPDATE):{
@@ -790,71 +1572,35 @@ void SpineMLSplitter::splitProperties(Component *component, Component *sub_compo
                         WeightUpdate *sub_synapse = (WeightUpdate*)sub_component;
                         switch(synapse->target_connectivity->Type()){
                             case(ALL_TO_ALL_CONNECTVITY_TYPE):{
-                                uint sub_pop_offset = sub_comp_index*(MAX_POPULATION_SIZE*target_pop_size);            //offset by total number of index items per sub_population to sub_projection
-                                uint target_sub_pop_offset = target_sub_pop_index*MAX_POPULATION_SIZE;                 //offset by the sub_projection destination index
-
-                                for (uint i=0;i<sub_comp_size;i++){                                                    //loop through source neurons
-                                    uint neuron_offset = i*target_pop_size;                                            //offset by source neuron item
-                                    for (uint j=0;j<target_sub_pop_size;j++)                                           //loop through dest neurons (i.e. ind. synapses)
-                                    {
-                                        uint index = sub_pop_offset+target_sub_pop_offset+neuron_offset+j;
-                                        if (property_value->valueInstances.contains(index)){
-                                           PropertyValueInstance* prop_inst = property_value->valueInstances[index];
-                                           PropertyValueInstance* sub_prop_inst = new PropertyValueInstance();
-                                           sub_prop_inst->index = j+(i*target_sub_pop_size);                           //remap to sub projection: (source neuron * dst_pop_size) + dst neuron
-                                           sub_prop_inst->value = prop_inst->value;
-                                           sub_prop_value->valueInstances[sub_prop_inst->index] = sub_prop_inst;
-                                       }
-                                    }
-                                }
+                                uint sub_pop_offset = sub_comp_start*target_pop_size;                                  //offset by total number of index items per sub_population to sub_projection
+                                uint target_sub_pop_offset = target_sub_pop_start;                                     //offset by the sub_projection destination index
+
+                                //dest neurons (i.e. ind. synapses) are contiguous rows of each source neuron. remap to sub projection: (source neuron * dst_pop_size) + dst neuron
+                                sub_prop_value->appendRows(property_value, sub_pop_offset+target_sub_pop_offset, sub_comp_size, target_pop_size, target_sub_pop_size);
                                 break;
                             }
                             case(ONE_TO_ONE_CONNECTVITY_TYPE):{
                                 //one to one mapping of neuron index and connection index (already checked in split projection)
-                                uint start_index = sub_comp_index*MAX_POPULATION_SIZE;            //sub_proj_dst_index = sub_population_index when connectivity is one to one
-                                for (uint j=start_index;j<start_index+(MAX_POPULATION_SIZE);j++)
-                                {
-                                    if (property_value->valueInstances.contains(j)){
-                                        PropertyValueInstance* prop_inst = property_value->valueInstances[j];
-                                        PropertyValueInstance* sub_prop_inst = new PropertyValueInstance();
-                                        sub_prop_inst->index = prop_inst->index % MAX_POPULATION_SIZE;          //remap to sub projection
-                                        sub_prop_inst->value = prop_inst->value;
-                                        sub_prop_value->valueInstances[sub_prop_inst->index] = sub_prop_inst;
-                                    }
-                                }
+                                //sub_proj_dst_index = sub_population_index when connectivity is one to one
+                                sub_prop_value->appendRange(property_value, sub_comp_start, sub_comp_size, 0);   //remap to sub projection
                                 break;
                             }
                             case(LIST_CONNECTVITY_TYPE):{
-                                ConnectionList *connection_list = (ConnectionList*)synapse->target_connectivity;
+                                //gather values through the unsplit connection index of each sub connection (recorded when the list was split)
                                 ConnectionList *sub_connection_list = (ConnectionList*)sub_synapse->target_connectivity;
-                                int start_index;
-                                int target_start_index;
-                                if (info_parser->getSplitterMode() == SPLITMODE_PROJ_DEF_AT_DST){
-                                    start_index = target_sub_pop_index*MAX_POPULATION_SIZE;
-                                    target_start_index = sub_comp_index*MAX_POPULATION_SIZE;
-                                }else{
-                                    start_index = sub_comp_index*MAX_POPULATION_SIZE;
-                                    target_start_index = target_sub_pop_index*MAX_POPULATION_SIZE;
+                                if (sub_connection_list->materialised || ((uint)sub_connection_list->parent_indices.size() != sub_connection_list->size())){
+                                    std::cerr << "Error: Sub connection list of synapse '" << synapse->name.toLocal8Bit().data() << "' has no unsplit connection indices for property value list '" << property->name.toLocal8Bit().data() << "'." << std::endl;
+                                    delete sub_prop_value;
+                                    exit(0);
                                 }
-                                for (int s=0; s<MAX_POPULATION_SIZE; s++){
-                                    if (connection_list->connectionMatrix.contains(start_index+s)){
-                                        for (int t=0; t<MAX_POPULATION_SIZE; t++){
-                                            if (connection_list->connectionMatrix[start_index+s].contains(target_start_index+t)){
-                                                ConnectionInstance *inst = connection_list->connectionMatrix[start_index+s][target_start_index+t];
-                                                ConnectionInstance *sub_inst = sub_connection_list->connectionMatrix[s][t];
-
-                                                if (property_value->valueInstances.contains(inst->index)){
-                                                    PropertyValueInstance* prop_inst = property_value->valueInstances[inst->index];
-                                                    PropertyValueInstance* sub_prop_inst = new PropertyValueInstance();
-                                                    sub_prop_inst->index = sub_inst->index;
-                                                    sub_prop_inst->value = prop_inst->value;
-                                                    sub_prop_value->valueInstances[sub_prop_inst->index] = sub_prop_inst;
-                                                }
-                                            }
-                                        }
-                                    }
-                                }
-
+                                sub_prop_value->appendGather(property_value, sub_connection_list->parent_indices, sub_connection_list->indices);
+                                break;
+                            }
+                            case(FIXED_PROBABILITY_CONNECTVITY_TYPE):{
+                                //values are indexed by the connections generated by the simulator (materialised lists generate their own) so can not be split
+                                std::cerr << "Error: Property value list '" << property->name.toLocal8Bit().data() << "' of synapse '" << synapse->name.toLocal8Bit().data() << "' can not be split for fixed probability connectivity." << std::endl;
+                                delete sub_prop_value;
+                                exit(0);
                                 break;
                             }
                             default:{
@@ -867,24 +1613,15 @@ void SpineMLSplitter::splitProperties(Component *component, Component *sub_compo
                         break;
                     }
                     case(COMPONENT_TYPE_POSTSYNAPSE):{
-                        uint start_index = target_sub_pop_index*MAX_POPULATION_SIZE;
-                        for (uint j=start_index;j<start_index+(target_sub_pop_size);j++)
-                        {
-                            if (property_value->valueInstances.contains(j)){
-                                PropertyValueInstance* prop_inst = property_value->valueInstances[j];
-                                PropertyValueInstance* sub_prop_inst = new PropertyValueInstance();
-                                sub_prop_inst->index = prop_inst->index % MAX_POPULATION_SIZE;          //remap to dst sub neuron
-                                sub_prop_inst->value = prop_inst->value;
-                                sub_prop_value->valueInstances[sub_prop_inst->index] = sub_prop_inst;
-                            }
-                        }
+                        sub_prop_value->appendRange(property_value, target_sub_pop_start, target_sub_pop_size, 0);   //remap to dst sub neuron
                         break;
                     }
                 }
 
                 //check property instances to see if the property is valid for the sub component
+                sub_prop_value->finalise();
                 sub_prop->value = (PropertyValue*)sub_prop_value;
-                if (sub_prop_value->valueInstances.size() > 0){
+                if (sub_prop_value->count() > 0){
                     sub_component->properties.append(sub_prop);
                 }else{
                     delete sub_prop; //forget the property no instances for sub component
@@ -936,6 +1673,123 @@ void SpineMLSplitter::splitProperties(Component *component, Component *sub_compo
     }
 }
 
+PropertyValueList *SpineMLSplitter::sampleProperty(PropertyValue *value, Component *component, Component *sub_component, uint sub_comp_start, uint sub_comp_size, uint target_sub_pop_start, uint target_sub_pop_size, uint target_pop_size)
+{
+    //values are sampled by the global index of each instance (neuron or connection of the unsplit component)
+    PropertyValueList *sub_prop_value = new PropertyValueList();
+    switch(component->Type()){
+        case(COMPONENT_TYPE_POPULATION):{
+            for (uint i=0; i<sub_comp_size; i++)
+                sub_prop_value->appendValue(i, PropertySampler::sample(value, sub_comp_start+i));
+            break;
+        }
+        case(COMPONENT_TYPE_WEIGHT_UPDATE):{
+            AbstractionConnection *sub_connectivity = ((WeightUpdate*)sub_component)->target_connectivity;
+            switch(sub_connectivity->Type()){
+                case(ALL_TO_ALL_CONNECTVITY_TYPE):{
+                    //global index is (src neuron * dst_pop_size) + dst neuron
+                    for (uint i=0; i<sub_comp_size; i++){
+                        quint64 neuron_offset = (quint64)(sub_comp_start+i)*target_pop_size + target_sub_pop_start;
+                        for (uint j=0; j<target_sub_pop_size; j++)
+                            sub_prop_value->appendValue(i*target_sub_pop_size+j, PropertySampler::sample(value, neuron_offset+j));
+                    }
+                    break;
+                }
+                case(ONE_TO_ONE_CONNECTVITY_TYPE):{
+                    for (uint i=0; i<sub_comp_size; i++)
+                        sub_prop_value->appendValue(i, PropertySampler::sample(value, sub_comp_start+i));
+                    break;
+                }
+                case(LIST_CONNECTVITY_TYPE):{
+                    ConnectionList *sub_connection_list = (ConnectionList*)sub_connectivity;
+                    if (!sub_connection_list->materialised){
+                        //global index is the connection index in the unsplit list
+                        for (int k=0; k<sub_connection_list->parent_indices.size(); k++)
+                            sub_prop_value->appendValue(sub_connection_list->indices[k], PropertySampler::sample(value, sub_connection_list->parent_indices[k]));
+                    }else{
+                        //materialised lists have no unsplit list so the global index is the pair (src neuron, dst neuron). Rows
+                        //are the local neurons which are the dst of projections defined at the dst
+                        bool local_is_src = (info_parser->getSplitterMode() != SPLITMODE_PROJ_DEF_AT_DST);
+                        for (uint r=0; r<sub_connection_list->rowCount(); r++){
+                            for (uint c=sub_connection_list->rowStart(r); c<sub_connection_list->rowEnd(r); c++){
+                                quint64 src = sub_comp_start + (local_is_src ? r : sub_connection_list->cols[c]);
+                                quint64 dst = target_sub_pop_start + (local_is_src ? sub_connection_list->cols[c] : r);
+                                sub_prop_value->appendValue(sub_connection_list->indices[c], PropertySampler::sample(value, (src << 32) | dst));
+                            }
+                        }
+                    }
+                    break;
+                }
+                default:{
+                    //no explicit connections (fixed probability) so the distribution is copied
+                    delete sub_prop_value;
+                    return NULL;
+                }
+            }
+            break;
+        }
+        case(COMPONENT_TYPE_POSTSYNAPSE):{
+            for (uint i=0; i<target_sub_pop_size; i++)
+                sub_prop_value->appendValue(i, PropertySampler::sample(value, target_sub_pop_start+i));
+            break;
+        }
+    }
+    sub_prop_value->finalise();
+    return sub_prop_value;
+}
+
+ConnectionList *SpineMLSplitter::materialiseFixedProbability(FixedProbabilityConnection *connection, bool local_is_src, uint row_start, uint row_size, uint col_start, uint col_size)
+{
+    //rows are the local (defining) neurons as in parsed projection lists, whichever end of the projection they are
+    ConnectionList *connection_list = new ConnectionList(true);
+    connection_list->materialised = true;
+    connection_list->delay = cloneDelayPropertyValue(connection->delay);
+
+    //a fixed delay is also stored per connection (other delays are given by the cloned delay distribution)
+    double delay = 0;
+    if ((connection->delay != NULL) && (connection->delay->Type() == FIXED_VALUE_TYPE))
+        delay = ((FixedPropertyValue*)connection->delay)->value;
+
+    //connection exists if the random value is below probability*2^32
+    quint64 threshold = 0;
+    if (connection->probability >= 1.0)
+        threshold = Q_UINT64_C(0x100000000);
+    else if (connection->probability > 0.0)
+        threshold = (quint64)(connection->probability * 4294967296.0);
+
+    uint src_start = local_is_src ? row_start : col_start;
+    uint src_end = src_start + (local_is_src ? row_size : col_size);
+    uint dst_start = local_is_src ? col_start : row_start;
+    uint dst_end = dst_start + (local_is_src ? col_size : row_size);
+
+    //values are keyed by (seed, src neuron) and counted by dst neuron block (four dst neurons per block) so the generated
+    //connections of the unsplit synapse do not depend on the partitions or on the thread generating them
+    quint32 key[2];
+    quint32 counter[4] = {0, 0, 0, 0};
+    quint32 random[4];
+    key[0] = (quint32)connection->seed;
+    for (uint s=src_start; s<src_end; s++){
+        key[1] = s;
+        for (uint block=dst_start/4; block*4<dst_end; block++){
+            counter[0] = block;
+            Philox4x32::generate(counter, key, random);
+            for (uint k=0; k<4; k++){
+                uint t = block*4 + k;
+                if ((t < dst_start) || (t >= dst_end) || ((quint64)random[k] >= threshold))
+                    continue;
+                if (local_is_src)
+                    connection_list->appendConnection(s - src_start, t - dst_start, delay, 0);
+                else
+                    connection_list->appendConnection(t - dst_start, s - src_start, delay, 0);
+            }
+        }
+    }
+
+    //re-index (rows are out of order if the local neurons are the dst of the projection)
+    connection_list->compress(true);
+    return connection_list;
+}
+
 PropertyValue *SpineMLSplitter::cloneDelayPropertyValue(PropertyValue *delay)
 {
     PropertyValue *delay_copy = NULL;
@@ -1039,7 +1893,7 @@ Input *SpineMLSplitter::getSubInput(Input *input, Component *sub_componenent, QS
                 break;
             }
             case(LIST_CONNECTVITY_TYPE):{
-                ConnectionList *sub_connection_list = new ConnectionList();
+                ConnectionList *sub_connection_list = new ConnectionList(false); //rows are dst neurons
                 sub_input->remapping = (AbstractionConnection*)sub_connection_list;
                 break;
             }
@@ -1056,6 +1910,80 @@ Input *SpineMLSplitter::getSubInput(Input *input, Component *sub_componenent, QS
     }
 }
 
+/******************split maxima****************/
+
+void SplitMaxima::update(Synapse *synapse, uint sub_synapse_count)
+{
+    if (sub_synapse_count > sub_syn_max.value(synapse, 0))
+        sub_syn_max[synapse] = sub_synapse_count;
+}
+
+void SplitMaxima::update(Input *input, uint sub_input_count)
+{
+    if (sub_input_count > sub_inp_max.value(input, 0))
+        sub_inp_max[input] = sub_input_count;
+}
+
+void SplitMaxima::updateLevels(Synapse *synapse, uint node_count, uint remote_count)
+{
+    if (node_count > sub_syn_node_max.value(synapse, 0))
+        sub_syn_node_max[synapse] = node_count;
+    if (remote_count > sub_syn_remote_max.value(synapse, 0))
+        sub_syn_remote_max[synapse] = remote_count;
+}
+
+void SplitMaxima::updateLevels(Input *input, uint node_count, uint remote_count)
+{
+    if (node_count > sub_inp_node_max.value(input, 0))
+        sub_inp_node_max[input] = node_count;
+    if (remote_count > sub_inp_remote_max.value(input, 0))
+        sub_inp_remote_max[input] = remote_count;
+}
+
+void SplitMaxima::merge(const SplitMaxima &maxima)
+{
+    for (QHash<Synapse*, uint>::const_iterator i = maxima.sub_syn_max.constBegin(); i != maxima.sub_syn_max.constEnd(); ++i)
+        update(i.key(), i.value());
+    for (QHash<Input*, uint>::const_iterator i = maxima.sub_inp_max.constBegin(); i != maxima.sub_inp_max.constEnd(); ++i)
+        update(i.key(), i.value());
+    for (QHash<Synapse*, uint>::const_iterator i = maxima.sub_syn_node_max.constBegin(); i != maxima.sub_syn_node_max.constEnd(); ++i)
+        updateLevels(i.key(), i.value(), 0);
+    for (QHash<Synapse*, uint>::const_iterator i = maxima.sub_syn_remote_max.constBegin(); i != maxima.sub_syn_remote_max.constEnd(); ++i)
+        updateLevels(i.key(), 0, i.value());
+    for (QHash<Input*, uint>::const_iterator i = maxima.sub_inp_node_max.constBegin(); i != maxima.sub_inp_node_max.constEnd(); ++i)
+        updateLevels(i.key(), i.value(), 0);
+    for (QHash<Input*, uint>::const_iterator i = maxima.sub_inp_remote_max.constBegin(); i != maxima.sub_inp_remote_max.constEnd(); ++i)
+        updateLevels(i.key(), 0, i.value());
+}
+
+void SplitMaxima::reduce()
+{
+    for (QHash<Synapse*, uint>::const_iterator i = sub_syn_max.constBegin(); i != sub_syn_max.constEnd(); ++i){
+        if (i.value() > i.key()->_sub_syn_max)
+            i.key()->_sub_syn_max = i.value();
+    }
+    for (QHash<Input*, uint>::const_iterator i = sub_inp_max.constBegin(); i != sub_inp_max.constEnd(); ++i){
+        if (i.value() > i.key()->sub_inp_max)
+            i.key()->sub_inp_max = i.value();
+    }
+    for (QHash<Synapse*, uint>::const_iterator i = sub_syn_node_max.constBegin(); i != sub_syn_node_max.constEnd(); ++i){
+        if (i.value() > i.key()->_sub_syn_node_max)
+            i.key()->_sub_syn_node_max = i.value();
+    }
+    for (QHash<Synapse*, uint>::const_iterator i = sub_syn_remote_max.constBegin(); i != sub_syn_remote_max.constEnd(); ++i){
+        if (i.value() > i.key()->_sub_syn_remote_max)
+            i.key()->_sub_syn_remote_max = i.value();
+    }
+    for (QHash<Input*, uint>::const_iterator i = sub_inp_node_max.constBegin(); i != sub_inp_node_max.constEnd(); ++i){
+        if (i.value() > i.key()->sub_inp_node_max)
+            i.key()->sub_inp_node_max = i.value();
+    }
+    for (QHash<Input*, uint>::const_iterator i = sub_inp_remote_max.constBegin(); i != sub_inp_remote_max.constEnd(); ++i){
+        if (i.value() > i.key()->sub_inp_remote_max)
+            i.key()->sub_inp_remote_max = i.value();
+    }
+}
+
 Parser *SpineMLSplitter::getParser()
 {
     return parser;
@@ -1071,3 +1999,97 @@ QString SpineMLSplitter::getSubName(QString parent_name, uint sub_index)
     name = name.arg(parent_name).arg(sub_index);
     return name;
 }
+
+void SpineMLSplitter::loadManifestFile(QString manifest_filename, QList<QString> &experiment_filenames, QList<QString> &output_filenames)
+{
+    //each line is an experiment file and an output file separated by a tab (or by spaces if neither path contains spaces).
+    //Relative paths are relative to the manifest.
+    QFile manifest_file(manifest_filename);
+    if (!manifest_file.open(QIODevice::ReadOnly | QIODevice::Text)){
+        std::cerr << "Error: Unable to open batch manifest file '" << manifest_filename.toLocal8Bit().data() << "'" << std::endl;
+        exit(0);
+    }
+    QDir manifest_dir = QFileInfo(manifest_filename).absoluteDir();
+    QTextStream in(&manifest_file);
+    uint line_number = 0;
+    while (!in.atEnd()){
+        QString line = in.readLine().trimmed();
+        line_number++;
+        if (line.isEmpty() || line.startsWith("#"))
+            continue;
+        QStringList fields = line.contains('\t') ? line.split('\t', QString::SkipEmptyParts) : line.split(' ', QString::SkipEmptyParts);
+        if (fields.size() != 2){
+            std::cerr << "Error (line " << line_number << "): Expected experiment file and output file in batch manifest file '" << manifest_filename.toLocal8Bit().data() << "'" << std::endl;
+            exit(0);
+        }
+        experiment_filenames.append(manifest_dir.absoluteFilePath(fields[0].trimmed()));
+        output_filenames.append(manifest_dir.absoluteFilePath(fields[1].trimmed()));
+    }
+    manifest_file.close();
+
+    if (experiment_filenames.isEmpty()){
+        std::cerr << "Error: Batch manifest file '" << manifest_filename.toLocal8Bit().data() << "' contains no experiments" << std::endl;
+        exit(0);
+    }
+}
+
+//orders populations by document order
+static bool globalIndexLessThan(PopulationInfo *a, PopulationInfo *b)
+{
+    return a->global_index < b->global_index;
+}
+
+void SpineMLSplitter::writeNodeMap(QString filename)
+{
+    //'sub_population_name node core' per sub population in population order (core is the index within the node)
+    QFile node_file(filename);
+    if (!node_file.open(QIODevice::WriteOnly | QIODevice::Text)){
+        std::cerr << "Error opening node output file: " << filename.toLocal8Bit().data() << std::endl;
+        exit(0);
+    }
+    QList<ComponentInfo*> components = info_parser->getComponentInfoList();
+    QVector<PopulationInfo*> populations;
+    for (int i=0; i<components.size(); i++){
+        if (components[i]->Type() == COMPONENT_TYPE_POPULATION)
+            populations.append((PopulationInfo*)components[i]);
+    }
+    std::sort(populations.begin(), populations.end(), globalIndexLessThan);
+
+    QTextStream out(&node_file);
+    out << "#sub_population_name node core" << "\n";
+    for (int i=0; i<populations.size(); i++){
+        const PopulationPartition &partition = populations[i]->partition;
+        for (uint s=0; s<partition.count(); s++)
+            out << getSubName(populations[i]->name, s) << " " << partition.node(s) << " " << partition.core(s) << "\n";
+    }
+    node_file.close();
+}
+
+void SpineMLSplitter::loadPartitionFile(QHash<QString, uint> &partition_sizes)
+{
+    //each line is a population name followed by its partition size (population names may contain spaces)
+    QFile partition_file(partition_filename);
+    if (!partition_file.open(QIODevice::ReadOnly | QIODevice::Text)){
+        std::cerr << "Error: Unable to open partition file '" << partition_filename.toLocal8Bit().data() << "'" << std::endl;
+        exit(0);
+    }
+    QTextStream in(&partition_file);
+    uint line_number = 0;
+    while (!in.atEnd()){
+        QString line = in.readLine().trimmed();
+        line_number++;
+        if (line.isEmpty() || line.startsWith("#"))
+            continue;
+        int separator = qMax(line.lastIndexOf(' '), line.lastIndexOf('\t'));
+        bool ok = false;
+        uint size = 0;
+        if (separator > 0)
+            size = line.mid(separator+1).toUInt(&ok);
+        if ((!ok) || (size == 0)){
+            std::cerr << "Error (line " << line_number << "): Expected population name and partition size in partition file '" << partition_filename.toLocal8Bit().data() << "'" << std::endl;
+            exit(0);
+        }
+        partition_sizes[line.left(separator).trimmed()] = size;
+    }
+    partition_file.close();
+}
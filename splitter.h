@@ -9,8 +9,15 @@
 #include "writer.h"
 #include "infoparser.h"
 #include "parser.h"
+#include "pipeline.h"
+#include "mappedinputfile.h"
+#include "splitcache.h"
 
-#define MAX_POPULATION_SIZE 100
+#define MAX_POPULATION_SIZE 100    //default partition size
+
+#define SPLIT_SERIAL_GRAIN 20000      //populations with less estimated split work (neurons plus explicit connections) are split serially
+#define SPLIT_WINDOW_PER_THREAD 4     //sub populations split per thread before writing when streaming sub populations
+#define SPLIT_POPULATION_WINDOW_PER_THREAD 2  //populations split concurrently per thread before writing
 
 #define PARSER_DEBUG_OUTPUT 0
 #define SPLITTER_DEBUG_OUTPUT 0
@@ -18,6 +25,27 @@
 //int divide with ceil without cast to double
 #define UINT_DIV_CEIL(x,y) ((x + y - 1) / y)
 
+//maximum sub synapse and sub input counts found by one split task (merged then reduced into the unsplit synapses and
+//inputs once every sub population is split so threads never write the unsplit objects)
+class SplitMaxima
+{
+public:
+    void update(Synapse *synapse, uint sub_synapse_count);
+    void update(Input *input, uint sub_input_count);
+    void updateLevels(Synapse *synapse, uint node_count, uint remote_count);   //sub synapses within and outside the node partition
+    void updateLevels(Input *input, uint node_count, uint remote_count);
+    void merge(const SplitMaxima &maxima);
+    void reduce();      //raises _sub_syn_max and sub_inp_max (and their per level maxima) of the unsplit synapses and inputs
+
+public:
+    QHash<Synapse*, uint> sub_syn_max;
+    QHash<Input*, uint> sub_inp_max;
+    QHash<Synapse*, uint> sub_syn_node_max;
+    QHash<Synapse*, uint> sub_syn_remote_max;
+    QHash<Input*, uint> sub_inp_node_max;
+    QHash<Input*, uint> sub_inp_remote_max;
+};
+
 class SpineMLSplitter
 {
 public:
@@ -25,6 +53,23 @@ public:
     ~SpineMLSplitter();
 
     void split(QString experiment_input_filename, QString network_output_filename);
+    void splitBatch(QString manifest_filename);     //splits each network of the manifest experiments once for all of its experiments
+    void splitBuffer(const QByteArray &network_data, SpineMLWriter *sink);     //network document in memory, sub populations written to the sink
+    void splitModel(const QVector<Population*> &populations, SplitterMode splitter_mode, SpineMLWriter *sink); //populations built in memory (owned by the caller)
+    void setSink(SpineMLWriter *sink);  //writes split files to the sink instead of the writer of the mode (not deleted)
+    void setSinglePass(bool single_pass);
+    void setMappedInput(bool mapped_input);
+    void setPartitionSize(uint partition_size);
+    void setPartitionFile(QString partition_filename);
+    void setBalanced(bool balanced);
+    void setReordered(bool reordered);
+    void setPipelined(bool pipelined);
+    void setMaterialiseFixedProbability(bool materialise_fixed_probability);
+    void setSampledProperties(bool sampled_properties);
+    void setStreamed(bool streamed);
+    void setPlanned(bool planned);
+    void setNodeCount(uint node_count);
+    void setCache(SplitCache *cache);   //reuses the info, binary connections and definitions of previous splits (not deleted)
 
     uint getSplitPopulationCount();
     uint getSplitProjectionCount();
@@ -39,23 +84,51 @@ public:
 
 protected:
 
+    void initialise();
+    void parseInfo(MappedInputFile &input_file);
     void parseExperimentNetwork(Experiment* experiment, QString network_output_filename);
+    void parseNetwork(MappedInputFile &input_file, Experiment* experiment, QString network_output_filename);
     void parseExperimentFile(QString experiment_input_filename, QString network_output_filename);
+    Experiment *parseExperiment(QString experiment_input_filename);   //NULL if the file has no experiment
+    QString getNetworkFilename(Experiment* experiment);
     //population full parsing
     void parseAndSplitPopulations();   //TODO: Refactor to parser!!!
+    bool parseAndSplitPopulationsParallel(const char *network_data, qint64 network_size);
+    void parseAndSplitPopulationsPipelined();
+    Population *parsePopulationRange(const char *network_data, const PopulationRange &range, Parser *range_parser);
+    void parseAndSplitNetworkSinglePass(Experiment* experiment, QString network_output_filename);
+    void splitParsedNetwork(const QVector<Population*> &populations, const QVector<Arena*> &arenas, bool owns_populations, Experiment* experiment, QString network_output_filename);
+    void createWriter(Experiment* experiment, QString network_output_filename);
+    SpineMLWriter *createModeWriter(Experiment* experiment, QString network_output_filename);
+    void closeWriter();
 
 
     //splitter
-    void splitPopulation(Population *population, uint component_size);
-    void splitPopulationExplicit(Population *population, uint component_size);
-    void splitNeuron(Neuron *neuron, Neuron *sub_neuron, uint sub_pop_index, uint sub_pop_count);
-    void splitInputs(Component *componenent, Component *sub_componenent, uint sub_comp_index, uint sub_comp_size);
-    void splitProjections(Population *population, Population *sub_pop, uint sub_pop_index);
-    void splitWeightUpdate(Synapse *synapse, Synapse *sub_synapse, uint sub_pop_index, uint sub_pop_size, uint pop_size, uint target_sub_pop_index, uint target_sub_pop_size, uint target_pop_size);
-    void splitPostsynapse(Synapse *synapse, Synapse *sub_synapse, uint sub_pop_index, uint sub_pop_size, uint target_sub_pop_index, uint target_sub_pop_size);
-    void splitProperties(Component *component, Component *sub_component, uint sub_comp_index, uint sub_comp_size, uint target_sub_pop_index=0, uint target_sub_pop_size=0, uint target_pop_size=0); //dst_sub_pop_index & dst_sub_pop_size required only for synapse and postsynaspe, dst_pop_size required only for synapse
+    void bucketListConnections(Population *population);
+    void splitPopulation(Population *population);
+    void splitSubPopulations(Population *population, Population *sub_pops, uint first, uint count, const PopulationPartition &partition); //splits sub populations [first, first+count) into sub_pops
+    void splitSubPopulationTasks(Population *population, Population *sub_pops, uint first, uint count, const PopulationPartition &partition);
+    void splitAndWritePopulations(const QVector<Population*> &populations, const QVector<Arena*> &arenas);
+    quint64 splitWork(Population *population);
+    void countSplitMaxima(Population *population, const PopulationPartition &partition);     //pre-pass which sets the sub synapse and sub input maxima without splitting
+    void countSubPopulationMaxima(Population *population, uint sub_pop_index, const PopulationPartition &partition, SplitMaxima &maxima);
+    void countSubSynapseMaxima(Synapse *synapse, uint sub_pop_start, uint sub_pop_size, uint target_sub_pop_start, uint target_sub_pop_size, SplitMaxima &maxima);
+    void countSubInputMaxima(Component *component, uint sub_comp_start, uint sub_comp_size, SplitMaxima &maxima);
+    void writeSubPopulations(Population *population, Population *sub_pops, uint count);
+    void countNodeMaxima(Population *population, Population *sub_pop, uint sub_pop_index, const PopulationPartition &partition, SplitMaxima &maxima); //per level maxima of hierarchical splits
+    void splitNeuron(Neuron *neuron, Neuron *sub_neuron, uint sub_pop_index, const PopulationPartition &partition, SplitMaxima &maxima);
+    void splitInputs(Component *componenent, Component *sub_componenent, uint sub_comp_index, uint sub_comp_start, uint sub_comp_size, SplitMaxima &maxima);
+    template <bool UNIFORM> void splitListInput(Input *input, Component *sub_componenent, uint sub_comp_start, uint sub_comp_size, const PopulationPartition &src_partition, SplitMaxima &maxima); //specialised on the src partition being uniform
+    void splitProjections(Population *population, Population *sub_pop, uint sub_pop_index, SplitMaxima &maxima);
+    //synapse kernels specialised on the projection mode (selected once per synapse)
+    template <SplitterMode MODE> void splitSynapse(Population *population, Population *sub_pop, uint sub_pop_index, const PopulationPartition &partition, Projection *projection, Synapse *synapse, PopulationInfo *target_pop_info, SplitMaxima &maxima);
+    template <SplitterMode MODE> void splitWeightUpdate(Synapse *synapse, Synapse *sub_synapse, uint sub_pop_index, uint sub_pop_start, uint sub_pop_size, uint pop_size, uint target_sub_pop_index, uint target_sub_pop_start, uint target_sub_pop_size, uint target_pop_size, SplitMaxima &maxima);
+    template <SplitterMode MODE> void splitPostsynapse(Synapse *synapse, Synapse *sub_synapse, uint sub_pop_index, uint sub_pop_start, uint sub_pop_size, uint target_sub_pop_index, uint target_sub_pop_start, uint target_sub_pop_size, SplitMaxima &maxima);
+    void splitProperties(Component *component, Component *sub_component, uint sub_comp_start, uint sub_comp_size, uint target_sub_pop_start=0, uint target_sub_pop_size=0, uint target_pop_size=0); //target start & size required only for synapse and postsynaspe, target_pop_size required only for synapse
     //splitter helper functions
+    PropertyValueList *sampleProperty(PropertyValue *value, Component *component, Component *sub_component, uint sub_comp_start, uint sub_comp_size, uint target_sub_pop_start, uint target_sub_pop_size, uint target_pop_size); //NULL if the sub component has no explicit instances
     PropertyValue *cloneDelayPropertyValue(PropertyValue *delay);
+    ConnectionList *materialiseFixedProbability(FixedProbabilityConnection *connection, bool local_is_src, uint row_start, uint row_size, uint col_start, uint col_size); //explicit connections between a block of rows (local neurons) and cols (target neurons)
     Projection *getSubProjection(Population *sub_population, QString dst_sub_population_name);           //gets an existing projection if one exists otherwise creates a new one
     Input *getSubInput(Input *input, Component *sub_componenent, QString src_unique_name, QString src_sub_comp_name, uint &sub_input_count);             //gets an existing input if one exists otherwise creates a new one
 
@@ -63,6 +136,9 @@ protected:
 
 private:
     QString getSubName(QString name, uint sub_index);
+    void loadPartitionFile(QHash<QString, uint> &partition_sizes);
+    void writeNodeMap(QString filename);
+    void loadManifestFile(QString manifest_filename, QList<QString> &experiment_filenames, QList<QString> &output_filenames);
 
 
 private:
@@ -70,6 +146,21 @@ private:
     bool formatted_output;
     bool silent;
     WriterMode mode;
+    bool mapped_input;  //memory map input files rather than buffered reads
+    bool single_pass;   //parse the network with a single tokenisation rather than an info pass followed by a full pass
+    uint partition_size;        //default maximum sub population size
+    QString partition_filename; //optional file of per population partition sizes
+    uint node_count;            //node partitions of each population (hierarchical node then core split if more than 1)
+    bool balanced;              //balance the work of sub populations rather than splitting uniformly (requires single pass parsing)
+    bool reordered;             //renumber neurons to cluster list connectivity before splitting (requires single pass parsing)
+    bool pipelined;             //parse, split and write consecutive populations concurrently
+    bool materialise_fixed_probability; //generate explicit connection lists for fixed probability connectivity
+    bool sampled_properties;    //sample stochastic property values into value lists of the sub components
+    bool streamed;              //write and free windows of sub populations as they are split (bounds memory)
+    bool planned;               //report the split planned from the info parse without splitting
+    SplitCache *cache;          //cache of a resident splitter (NULL if none)
+    QList<Experiment*> batch_experiments;   //further experiments sharing the network being split (batch mode)
+    QList<QString> batch_outputs;
 
 
     uint split_populations;
@@ -78,6 +169,7 @@ private:
 
     QXmlStreamReader xml_src;
     SpineMLWriter *writer;
+    SpineMLWriter *sink;        //writer of the caller (used instead of creating a writer)
     InfoParser *info_parser;
     Parser *parser;
 
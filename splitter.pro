@@ -7,6 +7,7 @@
 QT       += core
 QT       -= gui
 QT       += xml
+QT       += network
 
 QMAKE_CXXFLAGS += -fopenmp -g
 
@@ -17,24 +18,8 @@ CONFIG   -= app_bundle
 TEMPLATE = app
 
 
-SOURCES += main.cpp \
-    modelobjects.cpp \
-    splitter.cpp \
-    writer.cpp \
-    xmlwriter.cpp \
-    infoparser.cpp \
-    parser.cpp \
-    aliaswriter.cpp \
-    graphwriter.cpp
-
-HEADERS += \
-    modelobjects.h \
-    splitter.h \
-    writer.h \
-    xmlwriter.h \
-    infoparser.h \
-    parser.h \
-    aliaswriter.h \
-    graphwriter.h
+include(splitterlib.pri)
+
+SOURCES += main.cpp
 
 LIBS += -fopenmp
@@ -0,0 +1,47 @@
+#splitter sources shared by the splitter application and library targets
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    modelobjects.cpp \
+    splitter.cpp \
+    writer.cpp \
+    xmlwriter.cpp \
+    infoparser.cpp \
+    parser.cpp \
+    aliaswriter.cpp \
+    graphwriter.cpp \
+    mappedinputfile.cpp \
+    binaryconnectionfile.cpp \
+    arena.cpp \
+    partitioner.cpp \
+    reorderer.cpp \
+    pipeline.cpp \
+    philox.cpp \
+    sampler.cpp \
+    planner.cpp \
+    splitcache.cpp \
+    splitdaemon.cpp \
+    fanoutwriter.cpp
+
+HEADERS += \
+    modelobjects.h \
+    splitter.h \
+    writer.h \
+    xmlwriter.h \
+    infoparser.h \
+    parser.h \
+    aliaswriter.h \
+    graphwriter.h \
+    mappedinputfile.h \
+    binaryconnectionfile.h \
+    arena.h \
+    partitioner.h \
+    reorderer.h \
+    pipeline.h \
+    philox.h \
+    sampler.h \
+    planner.h \
+    splitcache.h \
+    splitdaemon.h \
+    fanoutwriter.h
@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# Splitter library (in memory API of SpineMLSplitter)
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+QT       += xml
+QT       += network
+
+QMAKE_CXXFLAGS += -fopenmp -g
+
+TARGET = spinemlsplitter
+CONFIG   += staticlib
+
+TEMPLATE = lib
+
+
+include(splitterlib.pri)
+
+LIBS += -fopenmp
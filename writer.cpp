@@ -11,8 +11,16 @@ SpineMLWriter::SpineMLWriter(QString output_filename)
     }
 }
 
+SpineMLWriter::SpineMLWriter()
+{
+    output_file = NULL;
+}
+
 void SpineMLWriter::close()
 {
+    if (output_file == NULL)
+        return;
     output_file->close();
     delete output_file;
+    output_file = NULL;
 }
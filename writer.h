@@ -15,14 +15,16 @@ class SpineMLWriter
 {
 public:
     SpineMLWriter(QString output_filename);
+    SpineMLWriter();        //writer which does not open a file (output_file is NULL), e.g. an in memory sink
     virtual ~SpineMLWriter(){}
 
     virtual void writeDocumentStart() = 0;
     virtual void writeDocuemntEnd() = 0;
 
+    //sub populations (and the unsplit population) are freed once written so sinks must copy anything they keep
     virtual void writePopulation(Population *sub_population, Population *population = NULL) = 0;
 
-    void close();
+    virtual void close();
 
 protected:
     QFile* output_file;
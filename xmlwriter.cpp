@@ -1,6 +1,8 @@
 #include "xmlwriter.h"
 
 #include <iostream>
+#include <QFileInfo>
+#include <QtEndian>
 
 SpineMLXMLWriter::SpineMLXMLWriter(QString output_filename, bool formatted_output)
     : SpineMLWriter(output_filename)
@@ -11,6 +13,15 @@ SpineMLXMLWriter::SpineMLXMLWriter(QString output_filename, bool formatted_outpu
         xml_dst.setAutoFormatting(true);
 }
 
+SpineMLXMLWriter::SpineMLXMLWriter(QIODevice *device, bool formatted_output)
+    : SpineMLWriter()
+{
+    xml_dst.setDevice(device);
+    this->formatted_output = formatted_output;
+    if (formatted_output)
+        xml_dst.setAutoFormatting(true);
+}
+
 void SpineMLXMLWriter::writeDocumentStart()
 {
     xml_dst.writeStartDocument();
@@ -74,11 +85,10 @@ void SpineMLXMLWriter::writeProperty(Property *property)
         case(VALUE_LIST_TYPE):{
             PropertyValueList *value = (PropertyValueList*)property->value;
             xml_dst.writeStartElement("ValueList");
-            for(int i=0; i<value->valueInstances.values().size();i++){
-                PropertyValueInstance *inst = value->valueInstances.values().at(i);
+            for(int i=value->firstIndex(); i>=0; i=value->nextIndex(i)){
                 xml_dst.writeStartElement("Value");
-                xml_dst.writeAttribute("index", QString::number(inst->index));
-                xml_dst.writeAttribute("value", QString::number(inst->value));
+                xml_dst.writeAttribute("index", QString::number(i));
+                xml_dst.writeAttribute("value", QString::number(value->value(i)));
                 xml_dst.writeEndElement(); //Value
             }
             xml_dst.writeEndElement(); //valueList
@@ -194,7 +204,8 @@ void SpineMLXMLWriter::writeProjection(Projection *projection)
 void SpineMLXMLWriter::writeSynapse(Synapse *synapse)
 {
     xml_dst.writeStartElement("LL:Synapse");
-    writeConnection(synapse->connection);
+    //binary connection files are written alongside the output file (lists are written inline without one)
+    writeConnection(synapse->connection, (output_file != NULL) ? synapse->weightupdate->name : QString());
     //synapse
     writeWeightUpdate(synapse->weightupdate);
     //postsynapse
@@ -202,7 +213,7 @@ void SpineMLXMLWriter::writeSynapse(Synapse *synapse)
     xml_dst.writeEndElement(); //Target
 }
 
-void SpineMLXMLWriter::writeConnection(AbstractionConnection *connectivity)
+void SpineMLXMLWriter::writeConnection(AbstractionConnection *connectivity, QString binary_name)
 {
     if (connectivity == NULL)
         return;
@@ -224,14 +235,22 @@ void SpineMLXMLWriter::writeConnection(AbstractionConnection *connectivity)
         case(LIST_CONNECTVITY_TYPE):{
             ConnectionList *connection_list = (ConnectionList*) connectivity;
             xml_dst.writeStartElement("ConnectionList");
-            for (int i=0 ; i<connection_list->connectionIndices.values().size(); i++){
-                ConnectionInstance *inst = connection_list->connectionIndices.values().at(i);
-                xml_dst.writeStartElement("Connection");
-                xml_dst.writeAttribute("src_neuron", QString::number(inst->src_neuron));
-                xml_dst.writeAttribute("dst_neuron", QString::number(inst->dst_neuron));
-                xml_dst.writeAttribute("delay", QString::number(inst->delay));
-                xml_dst.writeAttribute("index", QString::number(inst->index));
-                xml_dst.writeEndElement(); //Connection
+            if (connection_list->materialised && !binary_name.isEmpty()){
+                writeDelay(connection_list->delay);
+                writeBinaryConnectionList(connection_list, binary_name);
+                xml_dst.writeEndElement(); //ConnectionList
+                break;
+            }
+            //compressed order (the index order of split lists)
+            for (uint r=0; r<connection_list->rowCount(); r++){
+                for (uint c=connection_list->rowStart(r); c<connection_list->rowEnd(r); c++){
+                    xml_dst.writeStartElement("Connection");
+                    xml_dst.writeAttribute("src_neuron", QString::number(connection_list->srcNeuron(r, c)));
+                    xml_dst.writeAttribute("dst_neuron", QString::number(connection_list->dstNeuron(r, c)));
+                    xml_dst.writeAttribute("delay", QString::number(connection_list->delays[c]));
+                    xml_dst.writeAttribute("index", QString::number(connection_list->indices[c]));
+                    xml_dst.writeEndElement(); //Connection
+                }
             }
             xml_dst.writeEndElement(); //ConnectionList
             break;
@@ -253,6 +272,37 @@ void SpineMLXMLWriter::writeConnection(AbstractionConnection *connectivity)
     }
 }
 
+void SpineMLXMLWriter::writeBinaryConnectionList(ConnectionList *connection_list, QString binary_name)
+{
+    //big endian (src, dst) pairs in compressed order written alongside the network file (prefixed by the network file
+    //name so networks split into the same directory do not overwrite each other's connections)
+    QFileInfo output_info(output_file->fileName());
+    QString filename = output_info.completeBaseName() + "_" + binary_name + ".bin";
+    QFile binary_file(output_info.absolutePath() + "/" + filename);
+    if (!binary_file.open(QIODevice::WriteOnly)){
+        std::cerr << "Error: Unable to open binary connection file '" << binary_file.fileName().toLocal8Bit().data() << "' for writing." << std::endl;
+        exit(0);
+    }
+    QByteArray data;
+    data.resize(connection_list->size() * 2 * sizeof(quint32));
+    uchar *pair = (uchar*)data.data();
+    for (uint r=0; r<connection_list->rowCount(); r++){
+        for (uint c=connection_list->rowStart(r); c<connection_list->rowEnd(r); c++){
+            qToBigEndian<quint32>(connection_list->srcNeuron(r, c), pair);
+            qToBigEndian<quint32>(connection_list->dstNeuron(r, c), pair + sizeof(quint32));
+            pair += 2 * sizeof(quint32);
+        }
+    }
+    binary_file.write(data);
+    binary_file.close();
+
+    xml_dst.writeStartElement("BinaryFile");
+    xml_dst.writeAttribute("file_name", filename);
+    xml_dst.writeAttribute("num_connections", QString::number(connection_list->size()));
+    xml_dst.writeAttribute("explicit_delay_flag", "0");
+    xml_dst.writeEndElement(); //BinaryFile
+}
+
 void SpineMLXMLWriter::writeWeightUpdate(WeightUpdate *weight_update)
 {
     xml_dst.writeStartElement("LL:WeightUpdate");
@@ -9,6 +9,7 @@ class SpineMLXMLWriter : public SpineMLWriter
 {
 public:
     SpineMLXMLWriter(QString output_filename, bool formatted_output);
+    SpineMLXMLWriter(QIODevice *device, bool formatted_output);    //writes to an open device (e.g. a QBuffer) rather than a file
 
     void writeDocumentStart();
     void writeDocuemntEnd();
@@ -20,7 +21,8 @@ public:
     void writeInput(Input *input);
     void writeProjection(Projection *projection);
     void writeSynapse(Synapse *synapse);
-    void writeConnection(AbstractionConnection *connectivity);
+    void writeConnection(AbstractionConnection *connectivity, QString binary_name = QString()); //materialised lists are written to binary_name.bin when a name is given
+    void writeBinaryConnectionList(ConnectionList *connection_list, QString binary_name);
     void writeWeightUpdate(WeightUpdate *weight_update);
     void writePostsynapse(Postsynapse *postsynapse);
 